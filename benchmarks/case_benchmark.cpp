@@ -0,0 +1,97 @@
+/*
+ASCII case conversion (ByteScanner::to_lowercase / to_uppercase) at every
+SIMD level, against the std::tolower loop appending to a growing string
+that the lowercase builtin used to run. Sizes go from 16 bytes to 64 MB,
+each is converted repeatedly until about 256 MB went through, throughput is
+input bytes per second. The allocating column is the builtin's cost: a new
+presized string per conversion, at the best level.
+
+Usage: case_benchmark
+*/
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+#include "../src/utils/byte_scanner.h"
+
+namespace {
+
+double best_time_ms(const std::function<void()>& run) {
+    double best = 1e18;
+    for (int round = 0; round < 5; round++) {
+        auto start = std::chrono::steady_clock::now();
+        run();
+        auto finish = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double, std::milli>(finish - start).count());
+    }
+    return best;
+}
+
+// Mixed case text with some non-ASCII bytes.
+std::string make_text(size_t size) {
+    const std::string words = "The Quick Brown Fox jumps over the LAZY DOG, caf\xc3\xa9 \xc3\x89t\xc3\xa9 ";
+    std::string text;
+    text.reserve(size + words.size());
+    while (text.size() < size)
+        text += words;
+    text.resize(size);
+    return text;
+}
+
+std::string old_lowercase(std::string_view text) {
+    std::string result;
+    for (auto u : text)
+        result += std::tolower(u);
+    return result;
+}
+
+}
+
+int main() {
+    std::cout << std::setw(10) << "size" << std::setw(12) << "tolower";
+    for (SimdLevel level : {SimdLevel::scalar, SimdLevel::sse2, SimdLevel::avx2})
+        std::cout << std::setw(12) << simd_level_name(level);
+    std::cout << std::setw(12) << "allocating" << "   (GB/s, lowercase)\n";
+
+    size_t checksum = 0; // keeps the results alive
+    for (size_t size = 16; size <= (64 << 20); size *= 4) {
+        std::string text = make_text(size);
+        size_t repeats = std::max<size_t>(1, (256 << 20) / size);
+        auto gb_per_s = [&](double ms, size_t runs) { return size * runs / ms / 1e6; };
+
+        size_t old_repeats = std::max<size_t>(1, repeats / 16); // much slower
+        double old_ms = best_time_ms([&]() {
+            for (size_t i = 0; i < old_repeats; i++)
+                checksum += old_lowercase(text).back();
+        });
+        std::cout << std::setw(10) << size << std::setw(12) << std::setprecision(3) << gb_per_s(old_ms, old_repeats);
+
+        std::string result(size, '\0');
+        for (SimdLevel level : {SimdLevel::scalar, SimdLevel::sse2, SimdLevel::avx2}) {
+            ByteScanner scanner(level);
+            double ms = best_time_ms([&]() {
+                for (size_t i = 0; i < repeats; i++) {
+                    scanner.to_lowercase(text, result.data());
+                    checksum += result.back();
+                }
+            });
+            std::cout << std::setw(12) << gb_per_s(ms, repeats);
+        }
+
+        // What the builtin does: a new presized string per conversion.
+        double builtin_ms = best_time_ms([&]() {
+            for (size_t i = 0; i < repeats; i++) {
+                std::string converted(size, '\0');
+                ByteScanner().to_lowercase(text, converted.data());
+                checksum += converted.back();
+            }
+        });
+        std::cout << std::setw(12) << gb_per_s(builtin_ms, repeats);
+        std::cout << "\n";
+    }
+    return checksum == 0;
+}
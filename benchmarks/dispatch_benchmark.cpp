@@ -0,0 +1,129 @@
+/*
+Dispatch-bound execution: long chains of add / subtract / gt on literals and
+variables, where the builtins are cheap and the time goes to getting from one
+operation to the next. Compares the tree walker (Interpreter::evaluate), the
+stack VM with switch dispatch and the stack VM with threaded dispatch, in time
+and in heap allocations per run. Lexing, parsing and compiling are done once
+up front and are not measured.
+
+Usage: dispatch_benchmark [expressions, default 20000] [repetitions, default 20]
+*/
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <new>
+#include <string>
+
+#include "../src/core/interpreter/interpreter.h"
+#include "../src/core/name_analyzer/name_analyzer.h"
+#include "../src/core/name_analyzer/type_checker.h"
+#include "../src/core/vm/stack_vm.h"
+
+namespace {
+
+size_t allocation_count = 0;
+
+}
+
+void* operator new(size_t size) {
+    allocation_count++;
+    if (void* pointer = std::malloc(size == 0 ? 1 : size))
+        return pointer;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* pointer) noexcept {
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, size_t) noexcept {
+    std::free(pointer);
+}
+
+namespace {
+
+// Variables are set once, a chain of updates goes through prefixa, prefixb, ..., prefixba, ...
+std::string variable_name(const std::string& prefix, size_t index) {
+    std::string digits;
+    for (; index > 0 || digits.empty(); index /= 26)
+        digits.insert(digits.begin(), char('a' + index % 26));
+    return prefix + digits;
+}
+
+// (set totalb (subtract (add totala 3 b) (add 1 (subtract b 2))))
+// (gt (add totalb (subtract b 1) 7) (subtract (add totalb 2) b))
+std::string make_program(size_t expression_count) {
+    std::string program = "(set " + variable_name("total", 0) + " 1) (set b 2)";
+    size_t updates = 0;
+    for (size_t i = 0; i < expression_count; i++) {
+        std::string total = variable_name("total", updates);
+        if (i % 2 == 0)
+            program += " (set " + variable_name("total", ++updates) + " (subtract (add " + total + " 3 b) (add 1 (subtract b 2))))";
+        else
+            program += " (gt (add " + total + " (subtract b 1) 7) (subtract (add " + total + " 2) b))";
+    }
+    return program;
+}
+
+struct Measurement {
+    double best_ms;
+    size_t allocations; // per run
+};
+
+Measurement measure(int repetitions, const std::function<void()>& run) {
+    Measurement measurement{1e18, 0};
+    for (int i = 0; i < repetitions; i++) {
+        size_t allocations_before = allocation_count;
+        auto start = std::chrono::steady_clock::now();
+        run();
+        auto finish = std::chrono::steady_clock::now();
+        measurement.allocations = allocation_count - allocations_before;
+        measurement.best_ms = std::min(measurement.best_ms, std::chrono::duration<double, std::milli>(finish - start).count());
+    }
+    return measurement;
+}
+
+}
+
+int main(int argc, char** argv) {
+    size_t expression_count = argc > 1 ? std::stoul(argv[1]) : 20000;
+    int repetitions = argc > 2 ? std::stoi(argv[2]) : 20;
+
+    std::string program = make_program(expression_count);
+    TokenStream tokens = Lexer().run(program);
+    AstArena arena;
+    Expr* root = Parser().parse(tokens, arena);
+    // Every engine runs in this context, a run sets the variables the previous one set.
+    std::shared_ptr<Context> context = std::make_shared<Context>();
+    NameAnalyzer(arena, context->get_symbol_table()).analyze(root);
+    context->allocate_slots();
+    TypeChecker(arena, *context).check(root);
+    Bytecode bytecode = BytecodeCompiler().compile(root);
+    std::shared_ptr<Printer> printer = std::make_shared<Printer>();
+
+    std::cout << expression_count << " expressions, " << bytecode.get_code().size() << " instructions, best of "
+              << repetitions << "\n";
+
+    Interpreter interpreter;
+    Measurement tree = measure(repetitions, [&]() {
+        interpreter.evaluate(root, context, printer);
+    });
+    std::cout << "tree walker: " << tree.best_ms << " ms, " << tree.allocations << " allocations per run\n";
+
+    for (Dispatch dispatch : {Dispatch::switch_loop, Dispatch::threaded}) {
+        StackVM vm(dispatch);
+        if (vm.get_dispatch() != dispatch) {
+            std::cout << dispatch_name(dispatch) << ": not compiled in\n";
+            continue;
+        }
+        Measurement vm_run = measure(repetitions, [&]() {
+            vm.run(bytecode, context, printer);
+        });
+        std::cout << "stack vm, " << dispatch_name(dispatch) << ": " << vm_run.best_ms << " ms, "
+                  << vm_run.best_ms * 1e6 / bytecode.get_code().size() << " ns per instruction, "
+                  << vm_run.allocations << " allocations per run\n";
+    }
+    return 0;
+}
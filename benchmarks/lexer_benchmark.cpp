@@ -0,0 +1,81 @@
+/*
+Lexer throughput on literal-heavy programs, for every SIMD level of the
+vectorized fast paths (whitespace runs and string literal bodies), and of
+the parallel lexer for a growing number of threads.
+
+Usage: lexer_benchmark [size in MB, default 32]
+*/
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+
+#include "../src/core/lexer/lexer.h"
+
+std::string generate_program(size_t target_size) {
+    std::mt19937 rng(42);
+    std::string alphabet = "abcdefghijklmnopqrstuvwxyz ABCDEFGHIJKLMNOPQRSTUVWXYZ,.:;!?";
+    std::string program;
+    int line = 0;
+    while (program.size() < target_size) {
+        std::string literal;
+        size_t length = 32 + rng() % 480;
+        for (size_t i = 0; i < length; i++)
+            literal += alphabet[rng() % alphabet.size()];
+        std::string indent(rng() % 16, ' ');
+        if (line % 3 == 0)
+            program += indent + "(set v" + std::string(1, 'a' + line % 26) + " (concat \"" + literal + "\" \"" + literal + "\"))\n";
+        else
+            program += indent + "(puts (uppercase \"" + literal + "\"))\n\n";
+        line++;
+    }
+    return program;
+}
+
+template<typename Run>
+double measure_seconds(Run run, size_t& token_count) {
+    double best = 1e100;
+    for (int repetition = 0; repetition < 5; repetition++) {
+        auto start = std::chrono::steady_clock::now();
+        TokenStream tokens = run();
+        auto finish = std::chrono::steady_clock::now();
+        token_count = tokens.size();
+        best = std::min(best, std::chrono::duration<double>(finish - start).count());
+    }
+    return best;
+}
+
+int main(int argc, char** argv) {
+    size_t size_mb = argc > 1 ? std::stoul(argv[1]) : 32;
+    std::string program = generate_program(size_mb << 20);
+    std::cout << "input: " << program.size() << " bytes, best supported level: "
+              << simd_level_name(ByteScanner::best_supported_level()) << "\n";
+
+    double scalar_seconds = 0;
+    for (SimdLevel level : {SimdLevel::scalar, SimdLevel::sse2, SimdLevel::avx2}) {
+        if (level > ByteScanner::best_supported_level())
+            continue;
+        Lexer lexer(level);
+        size_t token_count = 0;
+        double seconds = measure_seconds([&]() { return lexer.run(program); }, token_count);
+        if (level == SimdLevel::scalar)
+            scalar_seconds = seconds;
+        std::cout << simd_level_name(level) << ": " << token_count << " tokens, "
+                  << program.size() / seconds / 1e6 << " MB/s, speedup x"
+                  << scalar_seconds / seconds << "\n";
+    }
+
+    Lexer lexer;
+    double serial_seconds = 0;
+    for (size_t thread_count = 1; thread_count <= std::max(1u, std::thread::hardware_concurrency()); thread_count *= 2) {
+        size_t token_count = 0;
+        double seconds = measure_seconds([&]() { return lexer.run_parallel(program, thread_count); }, token_count);
+        if (thread_count == 1)
+            serial_seconds = seconds;
+        std::cout << "parallel, " << thread_count << " threads: " << token_count << " tokens, "
+                  << program.size() / seconds / 1e6 << " MB/s, speedup x"
+                  << serial_seconds / seconds << "\n";
+    }
+}
@@ -0,0 +1,112 @@
+/*
+Parser time and heap allocations, recursive descent (Parser::parse) against
+the table-driven concrete parse tree plus build_ast (Parser::parse_two_phase),
+on the programs of tests/tests_input.json. Lexing is done once up front
+and is not measured, freeing the trees is.
+
+Usage: parser_benchmark [test file, default ../tests/tests_input.json] [repetitions, default 2000]
+*/
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "../src/core/lexer/lexer.h"
+#include "../src/core/parser/parser.h"
+
+namespace {
+
+size_t allocation_count = 0;
+
+}
+
+void* operator new(size_t size) {
+    allocation_count++;
+    if (void* pointer = std::malloc(size == 0 ? 1 : size))
+        return pointer;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* pointer) noexcept {
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, size_t) noexcept {
+    std::free(pointer);
+}
+
+// The "in" programs of the test file that parse, without pulling in a JSON library.
+std::vector<std::string> read_test_programs(const std::string& path) {
+    std::ifstream file(path);
+    std::string json((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    std::vector<std::string> programs;
+    Lexer lexer;
+    Parser parser;
+    const std::string field = "\"in\": \"";
+    for (size_t begin = json.find(field); begin != std::string::npos; begin = json.find(field, begin)) {
+        std::string program;
+        for (begin += field.size(); begin < json.size() && json[begin] != '"'; begin++) {
+            if (json[begin] != '\\' || begin + 1 == json.size()) {
+                program += json[begin];
+                continue;
+            }
+            char next = json[++begin];
+            program += (next == 'n' ? '\n' : next == 't' ? '\t' : next);
+        }
+        try {
+            AstArena arena;
+            parser.parse(lexer.run(program), arena);
+            programs.push_back(program);
+        }
+        catch (const std::runtime_error&) { } // error test cases
+    }
+    return programs;
+}
+
+// Every program is parsed on its own: the concrete parse tree nests one level
+// per top-level expression, so one huge program would overflow build_ast's stack.
+template<typename Parse>
+void measure(const std::string& name, Parse parse, const std::vector<TokenStream>& programs, size_t repetitions) {
+    size_t token_count = 0;
+    for (const TokenStream& tokens : programs)
+        token_count += tokens.size() * repetitions;
+    double best = 1e100;
+    size_t allocations = 0;
+    for (int round = 0; round < 5; round++) {
+        size_t allocations_before = allocation_count;
+        auto start = std::chrono::steady_clock::now();
+        for (size_t repetition = 0; repetition < repetitions; repetition++) {
+            for (const TokenStream& tokens : programs) {
+                AstArena arena; // one per program, freeing it frees the tree
+                parse(tokens, arena);
+            }
+        }
+        auto finish = std::chrono::steady_clock::now();
+        allocations = allocation_count - allocations_before;
+        best = std::min(best, std::chrono::duration<double>(finish - start).count());
+    }
+    std::cout << name << ": " << best * 1e3 << " ms, " << token_count / best / 1e6 << " M tokens/s, "
+              << double(allocations) / token_count << " allocations per token\n";
+}
+
+int main(int argc, char** argv) {
+    std::string path = argc > 1 ? argv[1] : "../tests/tests_input.json";
+    size_t repetitions = argc > 2 ? std::stoul(argv[2]) : 2000;
+    std::vector<std::string> sources = read_test_programs(path);
+    if (sources.empty()) {
+        std::cerr << "no programs found in " << path << "\n";
+        return 1;
+    }
+    std::vector<TokenStream> programs;
+    for (const std::string& source : sources)
+        programs.push_back(Lexer().run(source));
+    std::cout << programs.size() << " programs, each parsed " << repetitions << " times\n";
+
+    Parser parser;
+    measure("two-phase", [&](const TokenStream& input, AstArena& arena) { return parser.parse_two_phase(input, arena); }, programs, repetitions);
+    measure("recursive descent", [&](const TokenStream& input, AstArena& arena) { return parser.parse(input, arena); }, programs, repetitions);
+}
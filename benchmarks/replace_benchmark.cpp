@@ -0,0 +1,100 @@
+/*
+The replace builtin on a large document, for patterns of several lengths:
+the SubstringSearcher based replace against the byte-by-byte loop it
+replaced, which compared a substr of the pattern's length at every position.
+Throughput is input bytes per second, for patterns occurring every few dozen
+bytes and for patterns occurring once; a plain memcpy of the document is
+printed as the memory bandwidth ceiling.
+
+Usage: replace_benchmark [document size in MB, default 10]
+*/
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "../src/core/interpreter/builtins.h"
+
+namespace {
+
+double best_time_ms(const std::function<void()>& run) {
+    double best = 1e18;
+    for (int round = 0; round < 5; round++) {
+        auto start = std::chrono::steady_clock::now();
+        run();
+        auto finish = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double, std::milli>(finish - start).count());
+    }
+    return best;
+}
+
+double gb_per_s(size_t bytes, double ms) {
+    return bytes / ms / 1e6;
+}
+
+// Words of a small alphabet, so that first bytes of the patterns match often.
+std::string make_document(size_t size) {
+    std::string document;
+    document.reserve(size);
+    for (size_t i = 0; document.size() < size; i++) {
+        document += "lorem ipsum dolor sit amet ";
+        document += std::to_string(i % 997);
+        document += i % 5 == 0 ? "\n" : " ";
+    }
+    document.resize(size);
+    return document;
+}
+
+std::string naive_replace(std::string_view target, std::string_view replaced, std::string_view replacement) {
+    std::string result;
+    for (size_t i = 0; i < target.size();) {
+        if (target.substr(i, replaced.size()) == replaced) {
+            result += replacement;
+            i += replaced.size();
+        }
+        else {
+            result += target[i];
+            i++;
+        }
+    }
+    return result;
+}
+
+}
+
+int main(int argc, char** argv) {
+    size_t size = (argc > 1 ? std::stoul(argv[1]) : 10) << 20;
+    std::string document = make_document(size);
+    // One occurrence near the end, so long patterns are scanned over the whole document.
+    std::string long_pattern = "the quick brown fox jumps over the lazy dog, twice";
+    document.replace(size - 1000, long_pattern.size(), long_pattern);
+    std::cout << (size >> 20) << " MB document\n";
+
+    size_t checksum = 0; // keeps the results alive
+    std::string copy(size, ' ');
+    double memcpy_ms = best_time_ms([&]() {
+        std::memcpy(copy.data(), document.data(), size);
+        checksum += copy[size / 2];
+    });
+    std::cout << "memcpy: " << gb_per_s(size, memcpy_ms) << " GB/s\n";
+
+    ReturnValue target{std::string(document)};
+    Printer printer;
+    // "\n", "sit" and "dolor si" occur every few dozen bytes, the fox patterns once.
+    for (std::string pattern : {"\n", "sit", "fox", "dolor si", "fox jump", long_pattern.c_str()}) {
+        std::vector<ReturnValue> args = {target, ReturnValue(std::string(pattern)), ReturnValue(std::string("X"))};
+        double replace_ms = best_time_ms([&]() {
+            checksum += apply_builtin(ExprKind::replace, args, 0, printer).as_string().size();
+        });
+        double naive_ms = best_time_ms([&]() {
+            checksum += naive_replace(document, pattern, "X").size();
+        });
+        std::cout << "\"" << pattern.substr(0, 8) << (pattern.size() > 8 ? "...\"" : "\"") << " ("
+                  << pattern.size() << " bytes): replace " << gb_per_s(size, replace_ms)
+                  << " GB/s, byte-by-byte loop " << gb_per_s(size, naive_ms) << " GB/s\n";
+    }
+    return checksum == 0;
+}
@@ -0,0 +1,89 @@
+/*
+Building strings out of many pieces: appending, prepending and an interpreted
+chain of (set next (concat previous "...")), with rope concatenation
+(SharedString::concat) against copying both operands into a new string on
+every concat, which is what the concat builtin used to do. The rope is flattened once at the end and
+that is measured too.
+
+Usage: rope_benchmark [pieces, default 10000] [piece size, default 100]
+*/
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <string>
+
+#include "../src/core/interpreter/interpreter.h"
+#include "../src/core/interpreter/shared_string.h"
+
+namespace {
+
+double best_time_ms(const std::function<void()>& run) {
+    double best = 1e18;
+    for (int round = 0; round < 5; round++) {
+        auto start = std::chrono::steady_clock::now();
+        run();
+        auto finish = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double, std::milli>(finish - start).count());
+    }
+    return best;
+}
+
+std::string make_piece(size_t index, size_t piece_size) {
+    return std::string(piece_size, char('a' + index % 26));
+}
+
+// Variables are set once: parta, partb, ..., partba, ...
+std::string variable_name(size_t index) {
+    std::string digits;
+    for (; index > 0 || digits.empty(); index /= 26)
+        digits.insert(digits.begin(), char('a' + index % 26));
+    return "part" + digits;
+}
+
+}
+
+int main(int argc, char** argv) {
+    size_t piece_count = argc > 1 ? std::stoul(argv[1]) : 10000;
+    size_t piece_size = argc > 2 ? std::stoul(argv[2]) : 100;
+    std::vector<SharedString> pieces;
+    for (size_t i = 0; i < piece_count; i++)
+        pieces.emplace_back(make_piece(i, piece_size));
+    std::cout << piece_count << " pieces of " << piece_size << " bytes\n";
+
+    size_t checksum = 0; // keeps the results alive
+    for (bool prepend : {false, true}) {
+        double rope_ms = best_time_ms([&]() {
+            SharedString result;
+            for (const SharedString& piece : pieces)
+                result = prepend ? SharedString::concat(piece, result) : SharedString::concat(result, piece);
+            checksum += result.view().size();
+        });
+        double copy_ms = best_time_ms([&]() {
+            SharedString result;
+            for (const SharedString& piece : pieces) {
+                std::string text;
+                text.reserve(result.size() + piece.size());
+                text += prepend ? piece.view() : result.view();
+                text += prepend ? result.view() : piece.view();
+                result = SharedString(std::move(text));
+            }
+            checksum += result.view().size();
+        });
+        std::cout << (prepend ? "prepend" : "append ") << ": rope " << rope_ms << " ms, copying " << copy_ms << " ms\n";
+    }
+
+    std::string program = "(set " + variable_name(0) + " \"\")";
+    for (size_t i = 0; i < piece_count; i++)
+        program += " (set " + variable_name(i + 1) + " (concat " + variable_name(i) + " \"" + make_piece(i, piece_size) + "\"))";
+    program += " (puts (substring " + variable_name(piece_count) + " 0 10))";
+    for (Evaluator evaluator : {Evaluator::tree_walker, Evaluator::stack_vm}) {
+        Interpreter interpreter(evaluator);
+        double interpreted_ms = best_time_ms([&]() {
+            checksum += interpreter.interpret(program).size();
+        });
+        std::cout << (evaluator == Evaluator::tree_walker ? "tree walker" : "stack vm") << ", concat chain (lexing and parsing included): "
+                  << interpreted_ms << " ms\n";
+    }
+    return checksum == 0;
+}
@@ -0,0 +1,65 @@
+/*
+Cold start latency: time from the start of main to the first evaluated
+expression, in a fresh process every time (the interpreter tables are
+process-wide, only the first Interpreter of a process pays for them).
+
+Usage: startup_benchmark [number of processes, default 50]
+*/
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../src/core/interpreter/interpreter.h"
+
+// Runs in the child process, prints the microseconds to the first output and
+// to the construction of a second interpreter.
+int measure_child() {
+    auto start = std::chrono::steady_clock::now();
+    Interpreter interpreter;
+    std::string output = interpreter.interpret("(puts \"hello\")");
+    auto first_output = std::chrono::steady_clock::now();
+    Interpreter second_interpreter;
+    auto second_construction = std::chrono::steady_clock::now();
+    if (output != "hello\n")
+        return 1;
+    std::cout << std::chrono::duration<double, std::micro>(first_output - start).count() << " "
+              << std::chrono::duration<double, std::micro>(second_construction - first_output).count() << "\n";
+    return 0;
+}
+
+double median(std::vector<double> values) {
+    std::sort(values.begin(), values.end());
+    return values[values.size() / 2];
+}
+
+int main(int argc, char** argv) {
+    if (argc > 1 && std::string(argv[1]) == "--child")
+        return measure_child();
+
+    int process_count = argc > 1 ? std::stoi(argv[1]) : 50;
+    std::vector<double> first_output_us, construction_us;
+    for (int i = 0; i < process_count; i++) {
+        FILE* child = popen((std::string(argv[0]) + " --child").c_str(), "r");
+        if (!child) {
+            std::cerr << "Cannot start " << argv[0] << "\n";
+            return 1;
+        }
+        double first_output = 0, construction = 0;
+        if (fscanf(child, "%lf %lf", &first_output, &construction) == 2) {
+            first_output_us.push_back(first_output);
+            construction_us.push_back(construction);
+        }
+        pclose(child);
+    }
+    if (first_output_us.empty()) {
+        std::cerr << "No measurements\n";
+        return 1;
+    }
+    std::cout << process_count << " processes, median main -> first evaluated expression: "
+              << median(first_output_us) << " us, median construction of another Interpreter: "
+              << median(construction_us) << " us\n";
+}
@@ -0,0 +1,159 @@
+/*
+Instruction counts and run time of the execution engines side by side: the
+tree walker (Interpreter::evaluate), the stack VM and the register VM, on the
+programs of tests/tests_input.json and on generated nested builtin calls.
+Lexing, parsing, name analysis and compiling are done once up front and are
+not measured.
+
+Usage: vm_benchmark [test file, default ../tests/tests_input.json] [repetitions, default 2000]
+*/
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../src/core/interpreter/interpreter.h"
+#include "../src/core/name_analyzer/name_analyzer.h"
+#include "../src/core/name_analyzer/type_checker.h"
+#include "../src/core/vm/register_vm.h"
+#include "../src/core/vm/stack_vm.h"
+
+namespace {
+
+// The "in" programs of the test file that parse, without pulling in a JSON library.
+std::vector<std::string> read_test_programs(const std::string& path) {
+    std::ifstream file(path);
+    std::string json((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    std::vector<std::string> programs;
+    Lexer lexer;
+    Parser parser;
+    const std::string field = "\"in\": \"";
+    for (size_t begin = json.find(field); begin != std::string::npos; begin = json.find(field, begin)) {
+        std::string program;
+        for (begin += field.size(); begin < json.size() && json[begin] != '"'; begin++) {
+            if (json[begin] != '\\' || begin + 1 == json.size()) {
+                program += json[begin];
+                continue;
+            }
+            char next = json[++begin];
+            program += (next == 'n' ? '\n' : next == 't' ? '\t' : next);
+        }
+        try {
+            AstArena arena;
+            parser.parse(lexer.run(program), arena);
+            programs.push_back(program);
+        }
+        catch (const std::runtime_error&) { } // error test cases
+    }
+    return programs;
+}
+
+// Variables are set once, a chain of updates goes through prefixa, prefixb, ..., prefixba, ...
+std::string variable_name(const std::string& prefix, size_t index) {
+    std::string digits;
+    for (; index > 0 || digits.empty(); index /= 26)
+        digits.insert(digits.begin(), char('a' + index % 26));
+    return prefix + digits;
+}
+
+std::string make_nested_calls(size_t expression_count) {
+    std::string program = "(set a \"Hello\") (set b \"World\") (set " + variable_name("count", 0) + " 1)";
+    size_t updates = 0;
+    for (size_t i = 0; i < expression_count; i++) {
+        std::string count = variable_name("count", updates);
+        if (i % 2 == 0)
+            program += " (set " + variable_name("text", i) + " (concat (uppercase a) (concat (substring b 0 3) (str (add " + count + " 2)))))";
+        else
+            program += " (set " + variable_name("count", ++updates) + " (subtract (add " + count + " (multiply 2 3)) (max 1 " + count + " 4)))";
+    }
+    return program;
+}
+
+struct Program {
+    AstArena arena;
+    Expr* root;
+    std::shared_ptr<Context> context; // every run sets the variables again
+    Bytecode bytecode;
+    RegisterCode register_code;
+};
+
+double best_time_ms(const std::function<void()>& run) {
+    double best = 1e18;
+    for (int round = 0; round < 5; round++) {
+        auto start = std::chrono::steady_clock::now();
+        run();
+        auto finish = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double, std::milli>(finish - start).count());
+    }
+    return best;
+}
+
+void measure(const std::string& name, const std::vector<std::string>& sources, size_t repetitions) {
+    std::vector<std::unique_ptr<Program>> programs;
+    size_t stack_instructions = 0, register_instructions = 0, registers = 0;
+    for (const std::string& source : sources) {
+        auto program = std::make_unique<Program>();
+        program->root = Parser().parse(Lexer().run(source), program->arena);
+        program->context = std::make_shared<Context>();
+        NameAnalyzer(program->arena, program->context->get_symbol_table()).analyze(program->root);
+        program->context->allocate_slots();
+        TypeChecker(program->arena, *program->context).check(program->root);
+        program->bytecode = BytecodeCompiler().compile(program->root);
+        program->register_code = RegisterCompiler().compile(program->root);
+        stack_instructions += program->bytecode.get_code().size();
+        register_instructions += program->register_code.get_code().size();
+        registers = std::max(registers, program->register_code.get_register_count());
+        programs.push_back(std::move(program));
+    }
+    std::shared_ptr<Printer> printer = std::make_shared<Printer>();
+    // Runtime errors of the test programs are part of the work, every engine raises them.
+    auto run_all = [&](const std::function<void(Program&, std::shared_ptr<Context>)>& run) {
+        return best_time_ms([&]() {
+            for (size_t repetition = 0; repetition < repetitions; repetition++) {
+                for (auto& program : programs) {
+                    try {
+                        run(*program, program->context);
+                    }
+                    catch (const ProgramError&) { }
+                    printer->clear_buffer();
+                }
+            }
+        });
+    };
+    Interpreter interpreter;
+    StackVM stack_vm;
+    RegisterVM register_vm;
+    double tree_ms = run_all([&](Program& program, std::shared_ptr<Context> context) {
+        interpreter.evaluate(program.root, context, printer);
+    });
+    double stack_ms = run_all([&](Program& program, std::shared_ptr<Context> context) {
+        stack_vm.run(program.bytecode, context, printer);
+    });
+    double register_ms = run_all([&](Program& program, std::shared_ptr<Context> context) {
+        register_vm.run(program.register_code, context, printer);
+    });
+    std::cout << name << " (" << programs.size() << " programs, run " << repetitions << " times)\n"
+              << "  tree walker:  " << tree_ms << " ms\n"
+              << "  stack vm:     " << stack_ms << " ms, " << stack_instructions << " instructions\n"
+              << "  register vm:  " << register_ms << " ms, " << register_instructions << " instructions, "
+              << registers << " registers (most used by a program)\n";
+}
+
+}
+
+int main(int argc, char** argv) {
+    std::string path = argc > 1 ? argv[1] : "../tests/tests_input.json";
+    size_t repetitions = argc > 2 ? std::stoul(argv[2]) : 2000;
+    std::vector<std::string> sources = read_test_programs(path);
+    if (sources.empty()) {
+        std::cerr << "no programs found in " << path << "\n";
+        return 1;
+    }
+    measure("test programs", sources, repetitions);
+    measure("nested calls", {make_nested_calls(20000)}, 1);
+    return 0;
+}
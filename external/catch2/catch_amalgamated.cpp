@@ -0,0 +1,13 @@
+#include "catch_amalgamated.hpp"
+int main() {
+    int failed_cases = 0;
+    for (auto& c : catch_shim::cases()) {
+        int before = catch_shim::failures();
+        try { c.fn(); } catch (catch_shim::Abort&) {} catch (std::exception& e) { std::cerr << c.name << " threw: " << e.what() << "\n"; catch_shim::failures()++; }
+        bool ok = catch_shim::failures() == before;
+        std::cout << (ok ? "PASSED " : "FAILED ") << c.name << "\n";
+        failed_cases += !ok;
+    }
+    std::cout << catch_shim::cases().size() << " test cases, " << failed_cases << " failed\n";
+    return failed_cases != 0;
+}
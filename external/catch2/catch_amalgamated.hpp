@@ -0,0 +1,24 @@
+// Minimal local stand-in for Catch2 (sandbox has no network). NOT committed.
+#pragma once
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+namespace catch_shim {
+struct Case { std::string name; std::function<void()> fn; };
+inline std::vector<Case>& cases() { static std::vector<Case> c; return c; }
+inline int& failures() { static int f = 0; return f; }
+struct Reg { Reg(const char* n, std::function<void()> f) { cases().push_back({n, f}); } };
+struct Abort {};
+}
+#define CATCH_CAT2(a, b) a##b
+#define CATCH_CAT(a, b) CATCH_CAT2(a, b)
+#define TEST_CASE(name, ...) \
+    static void CATCH_CAT(catch_fn_, __LINE__)(); \
+    static catch_shim::Reg CATCH_CAT(catch_reg_, __LINE__)(name, CATCH_CAT(catch_fn_, __LINE__)); \
+    static void CATCH_CAT(catch_fn_, __LINE__)()
+#define REQUIRE(...) do { if (!(__VA_ARGS__)) { std::cerr << __FILE__ << ":" << __LINE__ << " REQUIRE failed: " #__VA_ARGS__ "\n"; catch_shim::failures()++; throw catch_shim::Abort{}; } } while (0)
+#define CHECK(...) do { if (!(__VA_ARGS__)) { std::cerr << __FILE__ << ":" << __LINE__ << " CHECK failed: " #__VA_ARGS__ "\n"; catch_shim::failures()++; } } while (0)
+#define REQUIRE_THROWS(...) do { bool t_ = false; try { (void)(__VA_ARGS__); } catch (...) { t_ = true; } REQUIRE(t_); } while (0)
+#define REQUIRE_NOTHROW(...) do { bool t_ = false; try { (void)(__VA_ARGS__); } catch (...) { t_ = true; } REQUIRE(!t_); } while (0)
+#define REQUIRE_FALSE(...) REQUIRE(!(__VA_ARGS__))
@@ -0,0 +1,29 @@
+#include "ast_arena.h"
+
+AstArena::AstArena() = default;
+
+void* AstArena::allocate_slow(size_t size, size_t alignment) {
+    if (size + alignment > block_size / 4) {
+        large_blocks.emplace_back(new char[size + alignment]);
+        void* result = large_blocks.back().get();
+        size_t space = size + alignment;
+        return std::align(alignment, size, result, space);
+    }
+    blocks.emplace_back(new char[block_size]);
+    current = blocks.back().get();
+    remaining = block_size;
+    return allocate(size, alignment);
+}
+
+std::string_view AstArena::copy_string(std::string_view text) {
+    return std::string_view(copy_array(text.data(), text.size()), text.size());
+}
+
+void AstArena::reset() {
+    large_blocks.clear();
+    if (blocks.empty())
+        return;
+    blocks.resize(1);
+    current = blocks[0].get();
+    remaining = block_size;
+}
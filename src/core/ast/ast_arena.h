@@ -0,0 +1,65 @@
+#ifndef AST_ARENA_H
+#define AST_ARENA_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+/*
+Bump allocator for the nodes of one program, their child arrays and their strings.
+Nothing allocated here is destroyed one by one: the arena releases its blocks
+all at once, so objects created in it must not own any memory themselves.
+*/
+class AstArena {
+    private:
+        static constexpr size_t block_size = 1 << 16;
+
+        std::vector<std::unique_ptr<char[]>> blocks; // block_size each, the last one is current
+        std::vector<std::unique_ptr<char[]>> large_blocks; // requests that don't fit a block
+        char* current = nullptr;
+        size_t remaining = 0;
+
+        void* allocate_slow(size_t size, size_t alignment);
+    public:
+        AstArena();
+
+        AstArena(const AstArena&) = delete;
+
+        AstArena& operator=(const AstArena&) = delete;
+
+        void* allocate(size_t size, size_t alignment) {
+            size_t padding = (alignment - reinterpret_cast<uintptr_t>(current) % alignment) % alignment;
+            if (padding + size > remaining)
+                return allocate_slow(size, alignment);
+            void* result = current + padding;
+            current += padding + size;
+            remaining -= padding + size;
+            return result;
+        }
+
+        template<typename T, typename... Args>
+        T* create(Args&&... args) {
+            return new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+        }
+
+        template<typename T>
+        T* copy_array(const T* data, size_t count) {
+            if (count == 0)
+                return nullptr;
+            T* result = static_cast<T*>(allocate(sizeof(T) * count, alignof(T)));
+            std::memcpy(result, data, sizeof(T) * count);
+            return result;
+        }
+
+        std::string_view copy_string(std::string_view text);
+
+        // Drops everything allocated so far, the first block is kept for reuse.
+        void reset();
+};
+
+#endif // AST_ARENA_H
@@ -0,0 +1,73 @@
+#ifndef EXPR_KIND_H
+#define EXPR_KIND_H
+
+#include <cstdint>
+#include "../lexer/keywords.h"
+
+// Compact tag of an AST node. Builtin calls come first, in the order of
+// Keyword, so a keyword converts to the kind of its call with a cast.
+enum class ExprKind : uint8_t {
+    add,
+    set,
+    puts,
+    concat,
+    lowercase,
+    uppercase,
+    replace,
+    substring,
+    subtract,
+    multiply,
+    divide,
+    abs,
+    min,
+    max,
+    gt,
+    lt,
+    equal,
+    not_equal,
+    str,
+    identifier,
+    int_lit,
+    float_lit,
+    string_lit,
+    bool_lit,
+    null_lit,
+    error,
+    program, // the root, a ParseTempExpr holding the top-level expressions
+    // Builtin calls whose operand count and types the TypeChecker proved, they
+    // skip the checks. _int / _float is the type of the result.
+    add_int,
+    add_float,
+    subtract_int,
+    subtract_float,
+    multiply_int,
+    multiply_float,
+    divide_int,
+    divide_float,
+    min_int,
+    min_float,
+    max_int,
+    max_float,
+    abs_int,
+    abs_float,
+    gt_numeric,
+    lt_numeric,
+    concat_strings
+};
+
+static_assert(int(ExprKind::str) == int(Keyword::str) && int(ExprKind::identifier) == int(Keyword::none),
+              "builtin kinds must mirror Keyword");
+
+constexpr ExprKind expr_kind_of(Keyword keyword) {
+    return ExprKind(keyword);
+}
+
+constexpr bool is_specialized(ExprKind kind) {
+    return kind >= ExprKind::add_int;
+}
+
+constexpr bool is_builtin(ExprKind kind) {
+    return kind <= ExprKind::str || is_specialized(kind);
+}
+
+#endif // EXPR_KIND_H
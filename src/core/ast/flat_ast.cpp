@@ -0,0 +1,40 @@
+#include "flat_ast.h"
+
+FlatAst::FlatAst(Expr* root) {
+    // The node array doubles as the breadth-first queue.
+    std::vector<Expr*> nodes = {root};
+    for (size_t node = 0; node < nodes.size(); node++) {
+        Expr* expr = nodes[node];
+        ExprKind kind = expr->get_kind();
+        ExprSpan children = expr->get_children();
+        kinds.push_back(kind);
+        payloads.push_back(add_payload(expr, kind));
+        first_children.push_back(NodeId(nodes.size()));
+        children_counts.push_back(uint32_t(children.size()));
+        positions.push_back(expr->get_position());
+        nodes.insert(nodes.end(), children.begin(), children.end());
+    }
+}
+
+uint32_t FlatAst::add_payload(Expr* expr, ExprKind kind) {
+    switch (kind) {
+        case ExprKind::int_lit:
+            int_values.push_back(static_cast<IntLiteral*>(expr)->get_value());
+            return uint32_t(int_values.size() - 1);
+        case ExprKind::float_lit:
+            float_values.push_back(static_cast<FloatLiteral*>(expr)->get_value());
+            return uint32_t(float_values.size() - 1);
+        case ExprKind::bool_lit:
+            return static_cast<BoolLiteral*>(expr)->get_value();
+        case ExprKind::string_lit:
+            strings.emplace_back(static_cast<StringLiteral*>(expr)->get_value());
+            return uint32_t(strings.size() - 1);
+        case ExprKind::identifier:
+            return static_cast<IdentifierExpr*>(expr)->get_slot();
+        case ExprKind::error:
+            strings.emplace_back(static_cast<ErrorExpr*>(expr)->get_value());
+            return uint32_t(strings.size() - 1);
+        default:
+            return 0;
+    }
+}
@@ -0,0 +1,98 @@
+#ifndef FLAT_AST_H
+#define FLAT_AST_H
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+#include "expr_kind.h"
+#include "tree_module.h"
+
+using NodeId = uint32_t;
+
+// Read-only span of consecutive node ids, the children of a node.
+class NodeRange {
+    private:
+        NodeId first;
+        NodeId last;
+    public:
+        class iterator {
+            private:
+                NodeId node;
+            public:
+                iterator(NodeId node) : node(node) { }
+
+                NodeId operator*() const { return node; }
+
+                iterator& operator++() { node++; return *this; }
+
+                bool operator!=(const iterator& other) const { return node != other.node; }
+        };
+
+        NodeRange(NodeId first, NodeId last) : first(first), last(last) { }
+
+        iterator begin() const { return iterator(first); }
+
+        iterator end() const { return iterator(last); }
+
+        size_t size() const { return last - first; }
+
+        bool empty() const { return first == last; }
+
+        NodeId operator[](size_t index) const { return first + NodeId(index); }
+};
+
+/*
+The AST flattened into parallel arrays (struct of arrays), nodes in breadth-first
+order. The children of a node are consecutive, so a child range is two numbers
+and no pointers are followed. Every node comes after its parent: a pass that
+needs parents before children scans the arrays forward, one that needs children
+before parents scans them backward.
+Literals and names are kept in per-type tables, the payload of a node is its
+index there (bool literals keep the value itself, identifiers the slot of
+their variable).
+Only the flat evaluator uses it: the NameAnalyzer and the TypeChecker work
+on the pointer tree, which is flattened once they're done, once per run.
+String payloads are views into the tree's arena, as the lexemes are.
+*/
+class FlatAst {
+    private:
+        std::vector<ExprKind> kinds;
+        std::vector<uint32_t> payloads;
+        std::vector<NodeId> first_children;
+        std::vector<uint32_t> children_counts;
+        std::vector<uint64_t> positions;
+
+        std::vector<int64_t> int_values;
+        std::vector<double> float_values;
+        std::vector<std::string_view> strings; // string literals and errors, into the arena of the tree
+
+        uint32_t add_payload(Expr* expr, ExprKind kind);
+    public:
+        // Flattens the tree rooted at root. Strings aren't copied, the arena of
+        // the tree has to outlive the FlatAst.
+        FlatAst(Expr* root);
+
+        size_t size() const { return kinds.size(); }
+
+        NodeId root() const { return 0; }
+
+        ExprKind get_kind(NodeId node) const { return kinds[node]; }
+
+        uint64_t get_position(NodeId node) const { return positions[node]; }
+
+        NodeRange get_children(NodeId node) const {
+            return NodeRange(first_children[node], first_children[node] + children_counts[node]);
+        }
+
+        int64_t get_int(NodeId node) const { return int_values[payloads[node]]; }
+
+        double get_float(NodeId node) const { return float_values[payloads[node]]; }
+
+        bool get_bool(NodeId node) const { return payloads[node] != 0; }
+
+        std::string_view get_string(NodeId node) const { return strings[payloads[node]]; }
+
+        uint32_t get_slot(NodeId node) const { return payloads[node]; }
+};
+
+#endif // FLAT_AST_H
@@ -6,22 +6,42 @@
 
 
 
+Expr::Expr(ExprKind kind) : kind(kind) { }
+
 Expr::~Expr() = default;
 
-std::vector<std::shared_ptr<Expr>> Expr::get_children() {
-    return children;
+void Expr::specialize(ExprKind specialized_kind) {
+    assert(is_builtin(kind) && is_specialized(specialized_kind));
+    kind = specialized_kind;
+}
+
+void Expr::set_static_type(Type type) {
+    static_type = type;
+}
+
+uint64_t Expr::get_position() {
+    return position;
+}
+
+void Expr::set_position(uint64_t position) {
+    this->position = position;
 }
 
-void Expr::push_back(std::shared_ptr<Expr> element) {
-    children.push_back(element);
+ExprSpan Expr::get_children() const {
+    return ExprSpan(children, children_count);
 }
 
-void Expr::modify(int index, std::shared_ptr<Expr> elem) {
+void Expr::modify(int index, Expr* elem) {
     children[index] = elem;
 }
 
-void Expr::reassign_children(std::vector<std::shared_ptr<Expr>> new_children) {
-    children = new_children;
+void Expr::reassign_children(AstArena& arena, const Expr* const* new_children, size_t count) {
+    children = arena.copy_array(const_cast<Expr* const*>(new_children), count);
+    children_count = count;
+}
+
+void Expr::reassign_children(AstArena& arena, const std::vector<Expr*>& new_children) {
+    reassign_children(arena, new_children.data(), new_children.size());
 }
 
 
@@ -41,249 +61,193 @@ void Expr::visualize(int tabs) {
 
 // CONSTRUCTORS
 
+PutsExpr::PutsExpr() : Expr(ExprKind::puts) { }
 
-PutsExpr::PutsExpr(std::shared_ptr<Expr> operand) {
-    this->push_back(operand);
-}
+AdditionExpr::AdditionExpr() : Expr(ExprKind::add) { }
 
-ToStrExpr::ToStrExpr(std::shared_ptr<Expr> operand) {
-    this->push_back(operand);
-}
+SubtractionExpr::SubtractionExpr() : Expr(ExprKind::subtract) { }
 
-ErrorExpr::ErrorExpr(std::string value) : value(value) { }
-
-std::string ErrorExpr::get_value() {
-    return value;
-}
+MultiplicationExpr::MultiplicationExpr() : Expr(ExprKind::multiply) { }
 
-AdditionExpr::AdditionExpr(std::vector<std::shared_ptr<Expr>> operands) {
-    for (auto operand : operands)
-        this->push_back(operand);
-}  
+DivisionExpr::DivisionExpr() : Expr(ExprKind::divide) { }
 
-SubtractionExpr::SubtractionExpr(std::shared_ptr<Expr> lhs, std::shared_ptr<Expr> rhs) {
-    this->push_back(lhs);
-    this->push_back(rhs);
-}
+GreaterThanExpr::GreaterThanExpr() : Expr(ExprKind::gt) { }
 
-MultiplicationExpr::MultiplicationExpr(std::vector<std::shared_ptr<Expr>> operands) {
-    for (auto operand : operands)
-        this->push_back(operand);
-}  
+LowerThanExpr::LowerThanExpr() : Expr(ExprKind::lt) { }
 
-DivisionExpr::DivisionExpr(std::shared_ptr<Expr> lhs, std::shared_ptr<Expr> rhs) {
-    this->push_back(lhs);
-    this->push_back(rhs);
-}
+EqualExpr::EqualExpr() : Expr(ExprKind::equal) { }
 
-GreaterThanExpr::GreaterThanExpr(std::shared_ptr<Expr> lhs, std::shared_ptr<Expr> rhs) {
-    this->push_back(lhs);
-    this->push_back(rhs);
-}
+NotEqualExpr::NotEqualExpr() : Expr(ExprKind::not_equal) { }
 
-LowerThanExpr::LowerThanExpr(std::shared_ptr<Expr> lhs, std::shared_ptr<Expr> rhs) {
-    this->push_back(lhs);
-    this->push_back(rhs);
-}
+MinExpr::MinExpr() : Expr(ExprKind::min) { }
 
-EqualExpr::EqualExpr(std::shared_ptr<Expr> lhs, std::shared_ptr<Expr> rhs) {
-    this->push_back(lhs);
-    this->push_back(rhs);
-}
+MaxExpr::MaxExpr() : Expr(ExprKind::max) { }
 
-NotEqualExpr::NotEqualExpr(std::shared_ptr<Expr> lhs, std::shared_ptr<Expr> rhs) {
-    this->push_back(lhs);
-    this->push_back(rhs);
-}
+AbsExpr::AbsExpr() : Expr(ExprKind::abs) { }
 
-MinExpr::MinExpr(std::shared_ptr<Expr> lhs, std::shared_ptr<Expr> rhs) {
-    this->push_back(lhs);
-    this->push_back(rhs);
-}
+SetExpr::SetExpr() : Expr(ExprKind::set) { }
 
-MaxExpr::MaxExpr(std::shared_ptr<Expr> lhs, std::shared_ptr<Expr> rhs) {
-    this->push_back(lhs);
-    this->push_back(rhs);
-}
+ToStrExpr::ToStrExpr() : Expr(ExprKind::str) { }
 
-AbsExpr::AbsExpr(std::shared_ptr<Expr> operand) {
-    this->push_back(operand);
-}
+ConcatExpr::ConcatExpr() : Expr(ExprKind::concat) { }
 
-SetExpr::SetExpr(std::shared_ptr<Expr> lhs, std::shared_ptr<Expr> rhs) {
-    this->push_back(lhs);
-    this->push_back(rhs);
-}
+ReplaceExpr::ReplaceExpr() : Expr(ExprKind::replace) { }
 
-ConcatExpr::ConcatExpr(std::shared_ptr<Expr> lhs, std::shared_ptr<Expr> rhs) {
-    this->push_back(lhs);
-    this->push_back(rhs);
-}
+SubstrExpr::SubstrExpr() : Expr(ExprKind::substring) { }
 
-ReplaceExpr::ReplaceExpr(std::shared_ptr<Expr> source, std::shared_ptr<Expr> pattern, std::shared_ptr<Expr> replacement) {
-    this->push_back(source);
-    this->push_back(pattern);
-    this->push_back(replacement);
-}
+LowercaseExpr::LowercaseExpr() : Expr(ExprKind::lowercase) { }
 
-SubstrExpr::SubstrExpr(std::shared_ptr<Expr> source, std::shared_ptr<Expr> l, std::shared_ptr<Expr> r) {
-    this->push_back(source);
-    this->push_back(l);
-    this->push_back(r);
-}
+UppercaseExpr::UppercaseExpr() : Expr(ExprKind::uppercase) { }
 
-LowercaseExpr::LowercaseExpr(std::shared_ptr<Expr> operand) {
-    this->push_back(operand);
-}
+ErrorExpr::ErrorExpr(std::string_view value) : Expr(ExprKind::error), value(value) { }
 
-UppercaseExpr::UppercaseExpr(std::shared_ptr<Expr> operand) {
-    this->push_back(operand);
+std::string_view ErrorExpr::get_value() {
+    return value;
 }
 
-IdentifierExpr::IdentifierExpr(std::string name) : name(name) { }
+IdentifierExpr::IdentifierExpr(std::string_view name) : Expr(ExprKind::identifier), name(name) { }
 
-std::string IdentifierExpr::get_name() {
+std::string_view IdentifierExpr::get_name() {
     return name;
 }
 
-IntLiteral::IntLiteral(int value) : value(value) { }
+void IdentifierExpr::set_slot(uint32_t slot) {
+    this->slot = slot;
+}
+
+IntLiteral::IntLiteral(int64_t value) : Expr(ExprKind::int_lit), value(value) { }
 
-int IntLiteral::get_value() {
+int64_t IntLiteral::get_value() {
     return value;
 }
 
-FloatLiteral::FloatLiteral(float value) : value(value) { }
+FloatLiteral::FloatLiteral(double value) : Expr(ExprKind::float_lit), value(value) { }
 
-float FloatLiteral::get_value() {
+double FloatLiteral::get_value() {
     return value;
 }
 
-StringLiteral::StringLiteral(std::string value) : value(value) { }
+StringLiteral::StringLiteral(std::string_view value) : Expr(ExprKind::string_lit), value(value) { }
 
-std::string StringLiteral::get_value() {
+std::string_view StringLiteral::get_value() {
     return value;
 }
 
-BoolLiteral::BoolLiteral(bool value) : value(value) { }
+BoolLiteral::BoolLiteral(bool value) : Expr(ExprKind::bool_lit), value(value) { }
 
 bool BoolLiteral::get_value() {
     return value;
 }
 
-NullLiteral::NullLiteral() { }
+NullLiteral::NullLiteral() : Expr(ExprKind::null_lit) { }
 
-ParseTempExpr::ParseTempExpr(std::string parse_type) : parse_type(parse_type) { }
+ParseTempExpr::ParseTempExpr(std::string_view parse_type) : Expr(ExprKind::program), parse_type(parse_type) { }
 
-std::string ParseTempExpr::get_parse_type() {
+std::string_view ParseTempExpr::get_parse_type() {
     return parse_type;
 }
 
 // CREATOR i.e. FACTORY METHOD
 
-ExprCreator::ExprCreator() = default;
-
-std::shared_ptr<Expr> ExprCreator::operator()(std::string expr_type) {
-    if (expr_type == "Keyword(add)") {
-        return std::make_shared<AdditionExpr>(std::vector<std::shared_ptr<Expr>>(0));
-    }
-    else if (expr_type == "Keyword(puts)") {
-        return std::make_shared<PutsExpr>(nullptr);
-    }
-    else if (expr_type == "Keyword(str)") {
-        return std::make_shared<ToStrExpr>(nullptr);
-    }    
-    else if (expr_type == "Keyword(subtract)") {
-        return std::make_shared<SubtractionExpr>(nullptr, nullptr);
-    }
-    else if (expr_type == "Keyword(multiply)") {
-        return std::make_shared<MultiplicationExpr>(std::vector<std::shared_ptr<Expr>>(0));
-    }
-    else if (expr_type == "Keyword(divide)") {
-        return std::make_shared<DivisionExpr>(nullptr, nullptr);
-    }
-    else if (expr_type == "Keyword(gt)") {
-        return std::make_shared<GreaterThanExpr>(nullptr, nullptr);
-    }
-    else if (expr_type == "Keyword(lt)") {
-        return std::make_shared<LowerThanExpr>(nullptr, nullptr);
-    }
-    else if (expr_type == "Keyword(equal)") {
-        return std::make_shared<EqualExpr>(nullptr, nullptr);
-    }
-    else if (expr_type == "Keyword(not_equal)") {
-        return std::make_shared<NotEqualExpr>(nullptr, nullptr);
-    }
-    else if (expr_type == "Keyword(min)") {
-        return std::make_shared<MinExpr>(nullptr, nullptr);
-    }
-    else if (expr_type == "Keyword(max)") {
-        return std::make_shared<MaxExpr>(nullptr, nullptr);
-    }
-    else if (expr_type == "Keyword(abs)") {
-        return std::make_shared<AbsExpr>(nullptr);
-    }
-    else if (expr_type == "Keyword(set)") {
-        return std::make_shared<SetExpr>(nullptr, nullptr);
-    }
-    else if (expr_type == "Keyword(concat)") {
-        return std::make_shared<ConcatExpr>(nullptr, nullptr);
-    }
-    else if (expr_type == "Keyword(replace)") {
-        return std::make_shared<ReplaceExpr>(nullptr, nullptr, nullptr);
-    }
-    else if (expr_type == "Keyword(substring)") {
-        return std::make_shared<SubstrExpr>(nullptr, nullptr, nullptr);
-    }
-    else if (expr_type == "Keyword(lowercase)") {
-        return std::make_shared<LowercaseExpr>(nullptr);
-    }
-    else if (expr_type == "Keyword(uppercase)") {
-        return std::make_shared<UppercaseExpr>(nullptr);
-    }
-    else if (expr_type == "Identifier") {
-        return std::make_shared<IdentifierExpr>(""); 
+ExprCreator::ExprCreator(AstArena& arena) : arena(arena) { }
+
+Expr* ExprCreator::operator()(Keyword keyword) {
+    switch (keyword) {
+        case Keyword::add:
+            return arena.create<AdditionExpr>();
+        case Keyword::puts:
+            return arena.create<PutsExpr>();
+        case Keyword::str:
+            return arena.create<ToStrExpr>();
+        case Keyword::subtract:
+            return arena.create<SubtractionExpr>();
+        case Keyword::multiply:
+            return arena.create<MultiplicationExpr>();
+        case Keyword::divide:
+            return arena.create<DivisionExpr>();
+        case Keyword::gt:
+            return arena.create<GreaterThanExpr>();
+        case Keyword::lt:
+            return arena.create<LowerThanExpr>();
+        case Keyword::equal:
+            return arena.create<EqualExpr>();
+        case Keyword::not_equal:
+            return arena.create<NotEqualExpr>();
+        case Keyword::min:
+            return arena.create<MinExpr>();
+        case Keyword::max:
+            return arena.create<MaxExpr>();
+        case Keyword::abs:
+            return arena.create<AbsExpr>();
+        case Keyword::set:
+            return arena.create<SetExpr>();
+        case Keyword::concat:
+            return arena.create<ConcatExpr>();
+        case Keyword::replace:
+            return arena.create<ReplaceExpr>();
+        case Keyword::substring:
+            return arena.create<SubstrExpr>();
+        case Keyword::lowercase:
+            return arena.create<LowercaseExpr>();
+        case Keyword::uppercase:
+            return arena.create<UppercaseExpr>();
+        case Keyword::none:
+            break;
+    }
+    assert(0);
+    return nullptr;
+}
+
+Expr* ExprCreator::operator()(std::string expr_type) {
+    if (expr_type.size() > 9 && expr_type.compare(0, 8, "Keyword(") == 0 && expr_type.back() == ')') {
+        const ReservedWord* reserved_word = find_reserved_word(std::string_view(expr_type).substr(8, expr_type.size() - 9));
+        assert(reserved_word != nullptr && reserved_word->kind == ReservedWordKind::keyword);
+        return (*this)(reserved_word->keyword);
+    }
+    if (expr_type == "Identifier") {
+        return arena.create<IdentifierExpr>(""); 
     }
     else if (expr_type == "IntLit") {
-        return std::make_shared<IntLiteral>(0);
+        return arena.create<IntLiteral>(0);
     }
     else if (expr_type == "FloatLit") {
-        return std::make_shared<FloatLiteral>(0);
+        return arena.create<FloatLiteral>(0);
     }
     else if (expr_type == "StringLit") {
-        return std::make_shared<StringLiteral>("");
+        return arena.create<StringLiteral>("");
     }
     else if (expr_type == "BoolLit") {
-        return std::make_shared<BoolLiteral>(false);
+        return arena.create<BoolLiteral>(false);
     }
     else if (expr_type == "NullLit") {
-        return std::make_shared<NullLiteral>();
+        return arena.create<NullLiteral>();
     }
     else if (expr_type == "Error") {
-        return std::make_shared<ErrorExpr>("Dummy Error");
+        return arena.create<ErrorExpr>("Dummy Error");
     }
     else if (expr_type == "Keyword") {
-        return std::make_shared<ParseTempExpr>("");
+        return arena.create<ParseTempExpr>("");
     }
     else if (expr_type == "Space" || expr_type == "EOF" || expr_type == "ParseTempExpr" || expr_type.substr(0, 14) == "DelimiterToken") {
-        return std::make_shared<ParseTempExpr>("");
+        return arena.create<ParseTempExpr>("");
     }
     else if (expr_type == "ParseTempExpr(Params)") {
-        return std::make_shared<ParseTempExpr>("Params");
+        return arena.create<ParseTempExpr>("Params");
     }
     else if (expr_type == "ParseTempExpr(Params\')") {
-        return std::make_shared<ParseTempExpr>("Params\'");
+        return arena.create<ParseTempExpr>("Params\'");
     }
     else if (expr_type == "ParseTempExpr(Literal)") {
-        return std::make_shared<ParseTempExpr>("Literal");
+        return arena.create<ParseTempExpr>("Literal");
     }
     else if (expr_type == "ParseTempExpr(Program)") {
-        return std::make_shared<ParseTempExpr>("Program");
+        return arena.create<ParseTempExpr>("Program");
     }
     else if (expr_type == "ParseTempExpr(Program\')") {
-        return std::make_shared<ParseTempExpr>("Program\'");
+        return arena.create<ParseTempExpr>("Program\'");
     }
     else if (expr_type == "ParseTempExpr(Expr)") {
-        return std::make_shared<ParseTempExpr>("Expr");
+        return arena.create<ParseTempExpr>("Expr");
     }
     else {
         std::cerr << expr_type << "\n";
@@ -466,10 +430,10 @@ void ExprVisitor::visit(ParseTempExpr& expr) { }
 //ParserTempTypeVisitor:
 
 void ParserTempTypeVisitor::visit(ParseTempExpr& expr) {
-    last_type = "(" + expr.get_parse_type() + ")";
+    last_type = "(" + std::string(expr.get_parse_type()) + ")";
 }
 
-std::string ParserTempTypeVisitor::get_parser_type(std::shared_ptr<Expr> expr, std::shared_ptr<ExprVisitor> visitor) {
+std::string ParserTempTypeVisitor::get_parser_type(Expr* expr, std::shared_ptr<ExprVisitor> visitor) {
     expr->accept(visitor);
     std::string answ = last_type;
     last_type = "";
@@ -477,7 +441,7 @@ std::string ParserTempTypeVisitor::get_parser_type(std::shared_ptr<Expr> expr, s
 }
 //ExprTypeVisitor:
 
-std::string ExprTypeVisitor::get_type(std::shared_ptr<Expr> expr, std::shared_ptr<ExprVisitor> visitor) {
+std::string ExprTypeVisitor::get_type(Expr* expr, std::shared_ptr<ExprVisitor> visitor) {
     expr->accept(visitor);
     std::string answ = last_type;
     last_type = "";
@@ -602,13 +566,6 @@ std::string ToStringVisitor::get_to_string(Expr* expr, std::shared_ptr<ExprVisit
     return answ;
 }
 
-std::string ToStringVisitor::get_to_string(std::shared_ptr<Expr> expr, std::shared_ptr<ExprVisitor> visitor) {
-    expr->accept(visitor);
-    std::string answ = last_result;
-    last_result = "";
-    return answ;
-}
-
 void ToStringVisitor::visit(PutsExpr& expr) {
     last_result = "PutsExpr";
 }
@@ -686,7 +643,7 @@ void ToStringVisitor::visit(UppercaseExpr& expr) {
 }
 
 void ToStringVisitor::visit(IdentifierExpr& expr) {
-    last_result = "IdentifierExpr(" + (expr.get_name()) + ")";
+    last_result = "IdentifierExpr(" + std::string(expr.get_name()) + ")";
 }
 
 void ToStringVisitor::visit(IntLiteral& expr) {
@@ -698,7 +655,7 @@ void ToStringVisitor::visit(FloatLiteral& expr) {
 }
 
 void ToStringVisitor::visit(StringLiteral& expr) {
-    last_result = "StringLiteralExpr(" + (expr.get_value()) + ")";
+    last_result = "StringLiteralExpr(" + std::string(expr.get_value()) + ")";
 }
 
 void ToStringVisitor::visit(BoolLiteral& expr) {
@@ -710,9 +667,9 @@ void ToStringVisitor::visit(NullLiteral& expr) {
 }
 
 void ToStringVisitor::visit(ErrorExpr& expr) {
-    last_result = "ErrorExpr(" + (expr.get_value()) + ")";
+    last_result = "ErrorExpr(" + std::string(expr.get_value()) + ")";
 }
 
 void ToStringVisitor::visit(ParseTempExpr& expr) {
-    last_result = "ParseTempExpr(" + expr.get_parse_type() + ")";
+    last_result = "ParseTempExpr(" + std::string(expr.get_parse_type()) + ")";
 }
\ No newline at end of file
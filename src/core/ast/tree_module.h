@@ -1,30 +1,79 @@
 #ifndef TREE_MODULE_H
 #define TREE_MODULE_H
 
+#include <cstdint>
 #include <string>
+#include <string_view>
 #include <memory>
 #include <vector>
+#include "ast_arena.h"
+#include "expr_kind.h"
+#include "value_type.h"
+#include "../lexer/keywords.h"
 
 
 class ExprVisitor;
 
 
+class Expr;
+
+// Read-only view of the children of a node.
+class ExprSpan {
+    private:
+        Expr* const* first;
+        size_t count;
+    public:
+        ExprSpan(Expr* const* first, size_t count) : first(first), count(count) { }
+
+        Expr* const* begin() const { return first; }
+
+        Expr* const* end() const { return first + count; }
+
+        size_t size() const { return count; }
+
+        bool empty() const { return count == 0; }
+
+        Expr* operator[](size_t index) const { return first[index]; }
+};
+
+
 // Abstract syntax tree
+// Nodes are created in the AstArena of their program and freed with it, never
+// one by one: children arrays and strings of a node are in the arena too.
 class Expr {
     private:
-        std::vector<std::shared_ptr<Expr>> children;
+        Expr** children = nullptr;
+        uint32_t children_count = 0;
+        ExprKind kind; // set by the subclass, evaluation switches on it
+        Type static_type = Type::error_type; // given by the TypeChecker
+        uint64_t position = 0; // byte offset in the source, for error messages
+    protected:
+        Expr(ExprKind kind);
     public:
         virtual ~Expr(); //  = default
 
+        ExprKind get_kind() const { return kind; }
+
+        // Only to a specialized variant of the builtin called, see the TypeChecker.
+        void specialize(ExprKind specialized_kind);
+
+        Type get_static_type() const { return static_type; }
+
+        void set_static_type(Type type);
+
+        uint64_t get_position();
+
+        void set_position(uint64_t position);
+
         virtual void accept(std::shared_ptr<ExprVisitor> visitor) = 0;
 
-        std::vector<std::shared_ptr<Expr>> get_children();
+        ExprSpan get_children() const;
 
-        void reassign_children(std::vector<std::shared_ptr<Expr>> new_children);
+        void reassign_children(AstArena& arena, const Expr* const* new_children, size_t count);
 
-        void modify(int index, std::shared_ptr<Expr> elem);
+        void reassign_children(AstArena& arena, const std::vector<Expr*>& new_children);
 
-        void push_back(std::shared_ptr<Expr> elem);
+        void modify(int index, Expr* elem);
 
         void visualize(int tabs);
 };  
@@ -35,7 +84,7 @@ class Expr {
 class PutsExpr : public Expr {
     private:
     public:
-        PutsExpr(std::shared_ptr<Expr> operand);
+        PutsExpr();
 
         void accept(std::shared_ptr<ExprVisitor> visitor) override;
 };
@@ -43,7 +92,7 @@ class PutsExpr : public Expr {
 class AdditionExpr : public Expr{
     private:
     public:
-        AdditionExpr(std::vector<std::shared_ptr<Expr>> operands);
+        AdditionExpr();
 
         void accept(std::shared_ptr<ExprVisitor> visitor) override;
 };
@@ -51,80 +100,80 @@ class AdditionExpr : public Expr{
 class SubtractionExpr : public Expr{
     private:
     public:
-        SubtractionExpr(std::shared_ptr<Expr> lhs, std::shared_ptr<Expr> rhs);
-        
+        SubtractionExpr();
+
         void accept(std::shared_ptr<ExprVisitor> visitor) override;
 };
 
 class MultiplicationExpr : public Expr{
     private:
     public:
-        MultiplicationExpr(std::vector<std::shared_ptr<Expr>> operands);
-        
+        MultiplicationExpr();
+
         void accept(std::shared_ptr<ExprVisitor> visitor) override;
 };
 
 class DivisionExpr : public Expr{
     private:
     public:
-        DivisionExpr(std::shared_ptr<Expr> lhs, std::shared_ptr<Expr> rhs);
-        
+        DivisionExpr();
+
         void accept(std::shared_ptr<ExprVisitor> visitor) override;
 };
 
 class GreaterThanExpr : public Expr{
     private:
     public:
-        GreaterThanExpr(std::shared_ptr<Expr> lhs, std::shared_ptr<Expr> rhs);
-        
+        GreaterThanExpr();
+
         void accept(std::shared_ptr<ExprVisitor> visitor) override;
 };
 
 class LowerThanExpr : public Expr{
     private:
     public:
-        LowerThanExpr(std::shared_ptr<Expr> lhs, std::shared_ptr<Expr> rhs);
-        
+        LowerThanExpr();
+
         void accept(std::shared_ptr<ExprVisitor> visitor) override;
 };
 
 class EqualExpr : public Expr{
     private:
     public:
-        EqualExpr(std::shared_ptr<Expr> lhs, std::shared_ptr<Expr> rhs);
-        
+        EqualExpr();
+
         void accept(std::shared_ptr<ExprVisitor> visitor) override;
 };
 
 class NotEqualExpr : public Expr{
     private:
     public:
-        NotEqualExpr(std::shared_ptr<Expr> lhs, std::shared_ptr<Expr> rhs);
-        
+        NotEqualExpr();
+
         void accept(std::shared_ptr<ExprVisitor> visitor) override;
 };
 
 class MinExpr : public Expr{
     private:
     public:
-        MinExpr(std::shared_ptr<Expr> lhs, std::shared_ptr<Expr> rhs);
-        
+        MinExpr();
+
         void accept(std::shared_ptr<ExprVisitor> visitor) override;
 };
 
 class MaxExpr : public Expr{
     private:
     public:
-        MaxExpr(std::shared_ptr<Expr> lhs, std::shared_ptr<Expr> rhs);
-        
+        MaxExpr();
+
         void accept(std::shared_ptr<ExprVisitor> visitor) override;
 };
 
 class AbsExpr : public Expr{
     private:
     public:
-        AbsExpr(std::shared_ptr<Expr> operand);
-        
+        AbsExpr();
+
         void accept(std::shared_ptr<ExprVisitor> visitor) override;
 };
 
@@ -132,8 +181,8 @@ class AbsExpr : public Expr{
 class SetExpr : public Expr{
     private:
     public:
-        SetExpr(std::shared_ptr<Expr> lhs, std::shared_ptr<Expr> rhs);
-        
+        SetExpr();
+
         void accept(std::shared_ptr<ExprVisitor> visitor) override;
 };
 
@@ -141,7 +190,7 @@ class SetExpr : public Expr{
 class ToStrExpr : public Expr {
     private:
     public:
-        ToStrExpr(std::shared_ptr<Expr> operand);
+        ToStrExpr();
 
         void accept(std::shared_ptr<ExprVisitor> visitor) override;
 };
@@ -149,51 +198,57 @@ class ToStrExpr : public Expr {
 class ConcatExpr : public Expr{
     private:
     public:
-        ConcatExpr(std::shared_ptr<Expr> lhs, std::shared_ptr<Expr> rhs);
-        
+        ConcatExpr();
+
         void accept(std::shared_ptr<ExprVisitor> visitor) override;
 };
 
 class ReplaceExpr : public Expr{
     private:
     public:
-        ReplaceExpr(std::shared_ptr<Expr> source, std::shared_ptr<Expr> pattern, std::shared_ptr<Expr> replacement);
-        
+        ReplaceExpr();
+
         void accept(std::shared_ptr<ExprVisitor> visitor) override;
 };
 
 class SubstrExpr : public Expr{
     private:
     public:
-        SubstrExpr(std::shared_ptr<Expr> source, std::shared_ptr<Expr> l, std::shared_ptr<Expr> r);
-        
+        SubstrExpr();
+
         void accept(std::shared_ptr<ExprVisitor> visitor) override;
 };
 
 class LowercaseExpr : public Expr{
     private:
     public:
-        LowercaseExpr(std::shared_ptr<Expr> operand);
-        
+        LowercaseExpr();
+
         void accept(std::shared_ptr<ExprVisitor> visitor) override;
 };
 
 class UppercaseExpr : public Expr{
     private:
     public:
-        UppercaseExpr(std::shared_ptr<Expr> operand);
-        
+        UppercaseExpr();
+
         void accept(std::shared_ptr<ExprVisitor> visitor) override;
 };
 
 // Identifier
 class IdentifierExpr : public Expr {
     private:
-        std::string name;
+        std::string_view name;
+        uint32_t slot = 0;
     public:
-        IdentifierExpr(std::string name);
+        IdentifierExpr(std::string_view name);
+
+        std::string_view get_name();
+
+        // Index of the variable's value in the Context, given by the NameAnalyzer.
+        uint32_t get_slot() const { return slot; }
 
-        std::string get_name();
+        void set_slot(uint32_t slot);
         
         void accept(std::shared_ptr<ExprVisitor> visitor) override;
 };
@@ -201,33 +256,33 @@ class IdentifierExpr : public Expr {
 // Literals
 class IntLiteral : public Expr {
     private:
-        int value;
+        int64_t value;
     public:
-        IntLiteral(int value);
+        IntLiteral(int64_t value);
 
-        int get_value();
+        int64_t get_value();
         
         void accept(std::shared_ptr<ExprVisitor> visitor) override;
 };
 
 class FloatLiteral : public Expr {
     private:
-        float value;
+        double value;
     public:
-        FloatLiteral(float value);
+        FloatLiteral(double value);
 
-        float get_value();
+        double get_value();
         
         void accept(std::shared_ptr<ExprVisitor> visitor) override;
 };
 
 class StringLiteral : public Expr {
     private:
-        std::string value;
+        std::string_view value;
     public:
-        StringLiteral(std::string value);
+        StringLiteral(std::string_view value);
 
-        std::string get_value();
+        std::string_view get_value();
         
         void accept(std::shared_ptr<ExprVisitor> visitor) override;
 };
@@ -251,13 +306,14 @@ class NullLiteral : public Expr {
         void accept(std::shared_ptr<ExprVisitor> visitor) override;
 };
 
+// Raises a program error once its children (if any) are evaluated.
 class ErrorExpr : public Expr {
     private:
-        std::string value;
+        std::string_view value;
     public:
-        ErrorExpr(std::string value);
+        ErrorExpr(std::string_view value);
 
-        std::string get_value();        
+        std::string_view get_value();        
 
         void accept(std::shared_ptr<ExprVisitor> visitor) override;
 };
@@ -266,25 +322,29 @@ class ErrorExpr : public Expr {
 
 class ParseTempExpr : public Expr {
     private:
-        std::string parse_type;
+        std::string_view parse_type;
     public:
-        ParseTempExpr(std::string parse_type);
+        ParseTempExpr(std::string_view parse_type);
 
-        std::string get_parse_type();
+        std::string_view get_parse_type();
 
         void accept(std::shared_ptr<ExprVisitor> visitor) override;
 };
 
 class ExprCreator {
+    private:
+        AstArena& arena;
     public:
-        ExprCreator();
+        ExprCreator(AstArena& arena);
 
         /*
             We always initialize AST node with some dummy value, during the parsing we will inject
             the real value into the node.
         */
 
-        std::shared_ptr<Expr> operator()(std::string expr_type);
+        Expr* operator()(std::string expr_type);
+
+        Expr* operator()(Keyword keyword);
 };
 
 
@@ -352,7 +412,7 @@ class ExprTypeVisitor : public ExprVisitor {
         std::string last_type;
     public:
         
-        std::string get_type(std::shared_ptr<Expr> expr, std::shared_ptr<ExprVisitor> visitor);
+        std::string get_type(Expr* expr, std::shared_ptr<ExprVisitor> visitor);
 
         void visit(PutsExpr& expr) override;
 
@@ -415,7 +475,7 @@ class ParserTempTypeVisitor : public ExprVisitor {
         std::string last_type;
     public:
 
-        std::string get_parser_type(std::shared_ptr<Expr> expr, std::shared_ptr<ExprVisitor> visitor);
+        std::string get_parser_type(Expr* expr, std::shared_ptr<ExprVisitor> visitor);
 
         void visit(ParseTempExpr& expr) override;
 };
@@ -428,8 +488,6 @@ class ToStringVisitor : public ExprVisitor {
 
         std::string get_to_string(Expr* expr, std::shared_ptr<ExprVisitor> visitor);
 
-        std::string get_to_string(std::shared_ptr<Expr> expr, std::shared_ptr<ExprVisitor> visitor);
-
         void visit(PutsExpr& expr) override;
 
         void visit(AdditionExpr& expr) override;
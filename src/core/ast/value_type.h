@@ -0,0 +1,17 @@
+#ifndef VALUE_TYPE_H
+#define VALUE_TYPE_H
+
+#include <cstdint>
+
+// Type of a runtime value, and of an expression once the TypeChecker ran:
+// error_type is then an expression that always raises.
+enum class Type : uint8_t {
+    int_type,
+    string_type,
+    null_type,
+    bool_type,
+    float_type,
+    error_type
+};
+
+#endif // VALUE_TYPE_H
@@ -0,0 +1,378 @@
+#include <cassert>
+#include <cmath>
+
+#include "builtins.h"
+#include "../../utils/byte_scanner.h"
+#include "../../utils/substring_search.h"
+
+namespace {
+
+void check(bool condition, uint64_t position) {
+    if (!condition)
+        throw ProgramError(position);
+}
+
+// Matches are found first, so the result is allocated once at its final size.
+// An empty pattern matches nothing: like a missing one, the source is returned.
+ReturnValue replace_all(const ReturnValue& source, std::string_view pattern, std::string_view replacement) {
+    std::string_view text = source.as_string();
+    std::vector<size_t> matches = SubstringSearcher(pattern).find_all(text);
+    if (matches.empty())
+        return source;
+    std::string result;
+    result.reserve(text.size() - matches.size() * pattern.size() + matches.size() * replacement.size());
+    size_t copied = 0;
+    for (size_t match : matches) {
+        result.append(text.data() + copied, match - copied);
+        result.append(replacement);
+        copied = match + pattern.size();
+    }
+    result.append(text.data() + copied, text.size() - copied);
+    return ReturnValue(std::move(result));
+}
+
+}
+
+ReturnValue apply_builtin(
+    ExprKind kind,
+    ValueSpan args_val,
+    uint64_t position,
+    Printer& printer
+) {
+    switch (kind) {
+        case ExprKind::puts: {
+            check(args_val.size() == 1, position);
+            check(args_val[0].get_type() == Type::string_type, position);
+            printer.add_output(std::string(args_val[0].as_string()));
+            return ReturnValue();
+        }
+        case ExprKind::str: {
+            check(args_val.size() == 1, position);
+            if (args_val[0].get_type() == Type::int_type) {
+                return ReturnValue(
+                    std::to_string(args_val[0].as_int())
+                );
+            }
+            else if (args_val[0].get_type() == Type::float_type) {
+                std::string str_repr = std::to_string(args_val[0].as_float());
+                str_repr = str_repr.substr(0, str_repr.find(".") + 5);
+                return ReturnValue(std::move(str_repr));
+            }
+            else if (args_val[0].get_type() == Type::bool_type) {
+                std::string bool_to_str = (args_val[0].as_bool() == true ? "true" : "false");
+                return ReturnValue(std::move(bool_to_str));
+            }
+            else if (args_val[0].get_type() == Type::string_type) {
+                return args_val[0];
+            }
+            else if (args_val[0].get_type() == Type::null_type) {
+                return ReturnValue(
+                    std::string("null")
+                ); 
+            }
+            break;
+        }
+        case ExprKind::add: {
+            check(args_val.size() != 0, position);
+            Type resultant_type = Type::int_type;
+            float result = 0;
+            for (const ReturnValue& val : args_val) {
+                Type v_type = val.get_type();
+                check(v_type == Type::float_type || v_type == Type::int_type, position);
+                if (v_type == Type::float_type)
+                    resultant_type = Type::float_type;
+                result += val.as_numerical();
+            }
+            if (resultant_type == Type::int_type) {
+                int result_ = result;
+                return ReturnValue(result_); 
+            }
+            return ReturnValue(result);
+        }
+        case ExprKind::subtract: {
+            check(args_val.size() == 2, position);
+            Type resultant_type = Type::int_type;
+            for (const ReturnValue& val : args_val) {
+                Type v_type = val.get_type();
+                check(v_type == Type::float_type || v_type == Type::int_type, position);
+                if (v_type == Type::float_type)
+                    resultant_type = Type::float_type;
+            }
+            float result = args_val[0].as_numerical() - args_val[1].as_numerical();
+            if (resultant_type == Type::int_type) {
+                int result_ = result;
+                return ReturnValue(result_); 
+            }
+            return ReturnValue(result);
+        }
+        case ExprKind::multiply: {
+            check(args_val.size() != 0, position);
+            Type resultant_type = Type::int_type;
+            float result = 1.0;
+            for (const ReturnValue& val : args_val) {
+                Type v_type = val.get_type();
+                check(v_type == Type::float_type || v_type == Type::int_type, position);
+                if (v_type == Type::float_type)
+                    resultant_type = Type::float_type;
+                result *= val.as_numerical();
+            }
+            if (resultant_type == Type::int_type) {
+                int result_ = result;
+                return ReturnValue(result_); 
+            }
+            return ReturnValue(result);
+        }
+        case ExprKind::divide: {
+            check(args_val.size() == 2, position);
+            Type resultant_type = Type::int_type;
+            for (const ReturnValue& val : args_val) {
+                Type v_type = val.get_type();
+                check(v_type == Type::float_type || v_type == Type::int_type, position);
+                if (v_type == Type::float_type)
+                    resultant_type = Type::float_type;
+            }
+            check(fabs(args_val[1].as_numerical()) >= 0.0000001, position);
+            float result = args_val[0].as_numerical() / args_val[1].as_numerical();
+            if (resultant_type == Type::int_type) {
+                int result_ = result;
+                return ReturnValue(result_); 
+            }
+            return ReturnValue(result);
+        }
+        case ExprKind::gt: {
+            check(args_val.size() == 2, position);
+            for (const ReturnValue& val : args_val) {
+                Type v_type = val.get_type();
+                check(v_type == Type::float_type || v_type == Type::int_type, position);
+            }
+            bool result = args_val[0].as_numerical() > args_val[1].as_numerical();
+            return ReturnValue((bool)(result));
+        }
+        case ExprKind::lt: {
+            check(args_val.size() == 2, position);
+            for (const ReturnValue& val : args_val) {
+                Type v_type = val.get_type();
+                check(v_type == Type::float_type || v_type == Type::int_type, position);
+            }
+            bool result = args_val[0].as_numerical() < args_val[1].as_numerical();
+            return ReturnValue((bool)(result));
+        }
+        case ExprKind::equal: {
+            check(args_val.size() == 2, position);
+            const ReturnValue& left_operand = args_val[0];
+            const ReturnValue& right_operand = args_val[1];
+            bool result = false;
+            if (left_operand.is_numerical() && right_operand.is_numerical()) {
+                result = (fabs(left_operand.as_numerical() - right_operand.as_numerical()) < 0.000001);
+            }
+            else if (left_operand.get_type() == right_operand.get_type()) {
+                if (left_operand.get_type() == Type::string_type) {
+                    result = (left_operand.as_string() == right_operand.as_string());
+                }
+                else if(left_operand.get_type() == Type::null_type) {
+                    result = true;
+                }
+                else if(left_operand.get_type() == Type::bool_type) {
+                    result = (left_operand.as_bool() == right_operand.as_bool());
+                }
+                else {
+                    assert(0); 
+                }
+            }
+            else {
+                result = false;
+            }
+            return ReturnValue((bool)(result));
+        }
+        case ExprKind::not_equal: {
+            check(args_val.size() == 2, position);
+            const ReturnValue& left_operand = args_val[0];
+            const ReturnValue& right_operand = args_val[1];
+            bool result = false;
+            if (left_operand.is_numerical() && right_operand.is_numerical()) {
+                result = (fabs(left_operand.as_numerical() - right_operand.as_numerical()) < 0.000001);
+            }
+            else if (left_operand.get_type() == right_operand.get_type()) {
+                if (left_operand.get_type() == Type::string_type) {
+                    result = (left_operand.as_string() == right_operand.as_string());
+                }
+                else if(left_operand.get_type() == Type::null_type) {
+                    result = true;
+                }
+                else if(left_operand.get_type() == Type::bool_type) {
+                    result = (left_operand.as_bool() == right_operand.as_bool());
+                }
+                else {
+                    assert(0); 
+                }
+            }
+            else {
+                result = false;
+            }
+            return ReturnValue((bool)(!result));        
+        }
+        case ExprKind::min: {
+            check(args_val.size() > 0, position);
+            Type resultant_type = Type::int_type;
+            float result = 2e9;
+            for (const ReturnValue& val : args_val) {
+                Type v_type = val.get_type();
+                check(v_type == Type::float_type || v_type == Type::int_type, position);
+                if (v_type == Type::float_type)
+                    resultant_type = Type::float_type;
+                result = std::min(result, val.as_numerical());
+            }
+            if (resultant_type == Type::int_type) {
+                int result_ = result;
+                return ReturnValue(result_); 
+            }
+            return ReturnValue(result);
+        }
+        case ExprKind::max: {
+            check(args_val.size() > 0, position);
+            Type resultant_type = Type::int_type;
+            float result = -2e9;
+            for (const ReturnValue& val : args_val) {
+                Type v_type = val.get_type();
+                check(v_type == Type::float_type || v_type == Type::int_type, position);
+                if (v_type == Type::float_type)
+                    resultant_type = Type::float_type;
+                result = std::max(result, val.as_numerical());
+            }
+            if (resultant_type == Type::int_type) {
+                int result_ = result;
+                return ReturnValue(result_); 
+            }
+            return ReturnValue(result);   
+        }
+        case ExprKind::abs: {
+            check(args_val.size() == 1, position);
+            const ReturnValue& operand = args_val[0];
+            Type resultant_type = Type::int_type;
+            for (const ReturnValue& val : args_val) {
+                check(val.is_numerical(), position);
+                if (val.get_type() == Type::float_type)
+                    resultant_type = Type::float_type;
+            }
+            float result = std::fabs(operand.as_numerical());
+            if (resultant_type == Type::int_type) {
+                int result_ = result;
+                return ReturnValue(result_); 
+            }
+            return ReturnValue(result);      
+        }
+        case ExprKind::concat: {
+            check(args_val.size() == 2, position);
+            const ReturnValue& left_operand = args_val[0];
+            const ReturnValue& right_operand = args_val[1];
+            check(left_operand.get_type() == Type::string_type, position);
+            check(right_operand.get_type() == Type::string_type, position);
+            return ReturnValue(SharedString::concat(left_operand.as_shared_string(), right_operand.as_shared_string()));
+        }
+        case ExprKind::replace: {
+            check(args_val.size() == 3, position);
+            const ReturnValue& target = args_val[0];
+            const ReturnValue& replaced = args_val[1];
+            const ReturnValue& replacement = args_val[2];
+            check(target.get_type() == Type::string_type, position);
+            check(replaced.get_type() == Type::string_type, position);
+            check(replacement.get_type() == Type::string_type, position);
+            return replace_all(target, replaced.as_string(), replacement.as_string());
+        }
+        case ExprKind::substring: {
+            check(args_val.size() == 3, position);
+            const ReturnValue& target = args_val[0];
+            const ReturnValue& left_pos = args_val[1];
+            const ReturnValue& right_pos = args_val[2];
+            check(target.get_type() == Type::string_type, position);
+            check(left_pos.get_type() == Type::int_type, position);
+            check(right_pos.get_type() == Type::int_type, position);
+            int left = left_pos.as_int(), right = right_pos.as_int();
+            check(0 <= left && left <= right && right <= (int)target.as_string().size(), position);
+            return ReturnValue(target.as_shared_string().substring(left, right - left));
+        }
+        case ExprKind::lowercase: {
+            check(args_val.size() == 1, position);
+            const ReturnValue& target = args_val[0];
+            check(target.get_type() == Type::string_type, position);
+            std::string_view text = target.as_string();
+            std::string result(text.size(), '\0');
+            ByteScanner().to_lowercase(text, result.data());
+            return ReturnValue(std::move(result));
+        }
+        case ExprKind::uppercase: {
+            check(args_val.size() == 1, position);
+            const ReturnValue& target = args_val[0];
+            check(target.get_type() == Type::string_type, position);
+            std::string_view text = target.as_string();
+            std::string result(text.size(), '\0');
+            ByteScanner().to_uppercase(text, result.data());
+            return ReturnValue(std::move(result));
+        }
+        // Specialized by the TypeChecker: the operands are numbers (ints only for
+        // the _int variants) or strings as required, in the right count. The
+        // computations are the same as above, in float.
+        case ExprKind::add_int: {
+            float result = 0;
+            for (const ReturnValue& val : args_val)
+                result += val.as_int();
+            return ReturnValue(int(result));
+        }
+        case ExprKind::add_float: {
+            float result = 0;
+            for (const ReturnValue& val : args_val)
+                result += val.as_numerical();
+            return ReturnValue(result);
+        }
+        case ExprKind::subtract_int:
+            return ReturnValue(int(args_val[0].as_numerical() - args_val[1].as_numerical()));
+        case ExprKind::subtract_float:
+            return ReturnValue(args_val[0].as_numerical() - args_val[1].as_numerical());
+        case ExprKind::multiply_int: {
+            float result = 1.0;
+            for (const ReturnValue& val : args_val)
+                result *= val.as_int();
+            return ReturnValue(int(result));
+        }
+        case ExprKind::multiply_float: {
+            float result = 1.0;
+            for (const ReturnValue& val : args_val)
+                result *= val.as_numerical();
+            return ReturnValue(result);
+        }
+        case ExprKind::divide_int:
+        case ExprKind::divide_float: {
+            check(fabs(args_val[1].as_numerical()) >= 0.0000001, position); // depends on the value
+            float result = args_val[0].as_numerical() / args_val[1].as_numerical();
+            return kind == ExprKind::divide_int ? ReturnValue(int(result)) : ReturnValue(result);
+        }
+        case ExprKind::min_int:
+        case ExprKind::min_float: {
+            float result = 2e9;
+            for (const ReturnValue& val : args_val)
+                result = std::min(result, val.as_numerical());
+            return kind == ExprKind::min_int ? ReturnValue(int(result)) : ReturnValue(result);
+        }
+        case ExprKind::max_int:
+        case ExprKind::max_float: {
+            float result = -2e9;
+            for (const ReturnValue& val : args_val)
+                result = std::max(result, val.as_numerical());
+            return kind == ExprKind::max_int ? ReturnValue(int(result)) : ReturnValue(result);
+        }
+        case ExprKind::abs_int:
+            return ReturnValue(int(std::fabs(args_val[0].as_numerical())));
+        case ExprKind::abs_float:
+            return ReturnValue(std::fabs(args_val[0].as_numerical()));
+        case ExprKind::gt_numeric:
+            return ReturnValue(args_val[0].as_numerical() > args_val[1].as_numerical());
+        case ExprKind::lt_numeric:
+            return ReturnValue(args_val[0].as_numerical() < args_val[1].as_numerical());
+        case ExprKind::concat_strings:
+            return ReturnValue(SharedString::concat(args_val[0].as_shared_string(), args_val[1].as_shared_string()));
+        default:
+            break;
+    }
+    assert(0);
+    return ReturnValue();
+}
@@ -0,0 +1,41 @@
+#ifndef BUILTINS_H
+#define BUILTINS_H
+
+#include <memory>
+#include <vector>
+#include "interpreter.h"
+
+// Read-only view of evaluated operands, a vector or a slice of a VM stack.
+class ValueSpan {
+    private:
+        const ReturnValue* first;
+        size_t count;
+    public:
+        ValueSpan(const ReturnValue* first, size_t count) : first(first), count(count) { }
+
+        ValueSpan(const std::vector<ReturnValue>& values) : first(values.data()), count(values.size()) { }
+
+        const ReturnValue* begin() const { return first; }
+
+        const ReturnValue* end() const { return first + count; }
+
+        size_t size() const { return count; }
+
+        const ReturnValue& operator[](size_t index) const { return first[index]; }
+};
+
+/*
+The builtin functions on already evaluated operands, shared by every evaluator
+so that they can't disagree on results or errors. set isn't one of them: its
+first operand is a name, not a value. Errors of the program are thrown as
+ProgramError at the given position. The specialized kinds trust the
+TypeChecker and only check what depends on the values.
+*/
+ReturnValue apply_builtin(
+    ExprKind kind,
+    ValueSpan args_val,
+    uint64_t position,
+    Printer& printer
+);
+
+#endif // BUILTINS_H
@@ -1,81 +1,14 @@
 #include "interpreter.h"
+#include "builtins.h"
+#include "../vm/stack_vm.h"
+#include "../vm/register_vm.h"
+#include "../name_analyzer/name_analyzer.h"
+#include "../name_analyzer/type_checker.h"
 #include <cmath>
 
-ReturnValue::ReturnValue() : type(Type::null_type), data(std::nanf("nan")) { }
-
-ReturnValue::ReturnValue(int val) : type(Type::int_type), data(val) { }
-
-ReturnValue::ReturnValue(bool val) : type(Type::bool_type), data(val) { }
-
-ReturnValue::ReturnValue(float val) : type(Type::float_type), data(val) { }
-
-ReturnValue::ReturnValue(std::string val) : type(Type::string_type), data(val) { }
-
-int ReturnValue::as_int() const {
-    return std::get<int>(data);
-}
-
-float ReturnValue::as_float() const {
-    return std::get<float>(data);
-}
-
-std::string ReturnValue::as_string() const {
-    return std::get<std::string>(data);
-}
-
-bool ReturnValue::as_bool() const {
-    return std::get<bool>(data);
-}
-
-Type ReturnValue::get_type() {
-    return type;
-}
-
-float ReturnValue::as_numerical() const {
-    assert(type == Type::float_type || type == Type::int_type);
-    if (type == Type::float_type)
-        return this->as_float();
-    return this->as_int();
-}
-
-bool ReturnValue::is_numerical() const {
-    return (type == Type::float_type || type == Type::int_type);
-}
-
-
-void SymbolTable::add(std::string var_name, std::shared_ptr<ReturnValue> value) {
-    symbol_table[var_name] = value;
-}
-
-std::shared_ptr<ReturnValue> SymbolTable::get(std::string var_name) {
-    if (!symbol_table.count(var_name)) {
-        return nullptr;
-    }
-    return symbol_table[var_name];
-}
-
-Type SymbolTable::get_type(std::string var_name) {
-    if (!symbol_table.count(var_name)) {
-        return Type::error_type;
-    }
-    return symbol_table[var_name]->get_type();
-}
-
-/*
-Quite useless context class.
-*/
-Context::Context() : symbol_table() {}
-
-void Context::insert_var(std::string var_name, std::shared_ptr<ReturnValue> value) {
-    symbol_table.add(var_name, value);
-}
-
-Type Context::get_type(std::string var_name) {
-    return symbol_table.get_type(var_name);
-}
-
-std::shared_ptr<ReturnValue> Context::get_val(std::string var_name) {
-    return symbol_table.get(var_name);
+void Context::discard_unset() {
+    symbol_table.truncate(set_count);
+    values.resize(set_count);
 }
 
 /*
@@ -97,354 +30,244 @@ std::string Printer::to_string() {
 }
 
 
-Interpreter::Interpreter() : lexer(), parser() { }
+namespace {
+
+// Errors of the program are reported at the position of the expression raising them.
+void check(bool condition, uint64_t position) {
+    if (!condition)
+        throw ProgramError(position);
+}
+
+void check(bool condition, Expr* expr) {
+    check(condition, expr->get_position());
+}
+
+// Evaluated operands of a call, on the C++ stack unless there are many of them.
+class OperandBuffer {
+    private:
+        static constexpr size_t inline_size = 4;
+        ReturnValue inline_values[inline_size];
+        std::vector<ReturnValue> heap_values;
+        ReturnValue* values;
+        size_t count;
+    public:
+        OperandBuffer(size_t count) : values(inline_values), count(count) {
+            if (count > inline_size) {
+                heap_values.resize(count);
+                values = heap_values.data();
+            }
+        }
 
-std::shared_ptr<ReturnValue> Interpreter::evaluate(
-    std::shared_ptr<Expr> expr, 
+        ReturnValue& operator[](size_t index) { return values[index]; }
+
+        ValueSpan span() const { return ValueSpan(values, count); }
+};
+
+}
+
+Interpreter::Interpreter(Evaluator evaluator) : lexer(), parser(), evaluator(evaluator) { }
+
+ReturnValue Interpreter::evaluate(
+    Expr* expr, 
     std::shared_ptr<Context> context, 
     std::shared_ptr<Printer> printer
 ) {
-    std::shared_ptr<ExprTypeVisitor> expr_type_visitor = std::make_shared<ExprTypeVisitor>();
-    std::string type = expr_type_visitor->get_type(expr, expr_type_visitor);
-    std::vector<std::shared_ptr<Expr>> args = expr->get_children();
-    std::vector<std::shared_ptr<ReturnValue>> args_val;
-    if(type == "SetExpr") {
-        assert(args.size() == 2);
-        std::shared_ptr<IdentifierExpr> var = std::dynamic_pointer_cast<IdentifierExpr>(args[0]);
-        context->insert_var(var->get_name(), this->evaluate(args[1], context, printer));
-        return std::make_shared<ReturnValue>();
-    }
-    for(auto arg : args)
-        args_val.push_back(this->evaluate(arg, context, printer));
-
-    if (type == "PutsExpr") {
-        assert(args_val.size() == 1);
-        assert(args_val[0]->get_type() == Type::string_type);
-        printer->add_output(args_val[0]->as_string());
-        return std::make_shared<ReturnValue>();
-    }
-    else if(type == "ToStrExpr") {
-        assert(args_val.size() == 1);
-        if (args_val[0]->get_type() == Type::int_type) {
-            return std::make_shared<ReturnValue>(
-                std::to_string(args_val[0]->as_int())
-            );
+    ExprSpan args = expr->get_children();
+    switch (expr->get_kind()) {
+        case ExprKind::set: // well formed, or the NameAnalyzer replaced it
+            context->set_var(static_cast<IdentifierExpr*>(args[0])->get_slot(), this->evaluate(args[1], context, printer));
+            return ReturnValue();
+        case ExprKind::int_lit:
+            // runtime numbers are int / float, int literals were checked to fit when the AST was built
+            return ReturnValue((int)(static_cast<IntLiteral*>(expr)->get_value()));
+        case ExprKind::float_lit:
+            return ReturnValue((float)(static_cast<FloatLiteral*>(expr)->get_value()));
+        case ExprKind::string_lit:
+            return ReturnValue(std::string(static_cast<StringLiteral*>(expr)->get_value()));
+        case ExprKind::bool_lit:
+            return ReturnValue((bool)(static_cast<BoolLiteral*>(expr)->get_value()));
+        case ExprKind::null_lit:
+            return ReturnValue();
+        case ExprKind::identifier:
+            return context->get_var(static_cast<IdentifierExpr*>(expr)->get_slot());
+        case ExprKind::error:
+            for (Expr* arg : args)
+                this->evaluate(arg, context, printer);
+            check(false, expr);
+            break;
+        case ExprKind::program:
+            for (Expr* arg : args)
+                this->evaluate(arg, context, printer);
+            return ReturnValue();
+        default: {
+            OperandBuffer args_val(args.size());
+            for (size_t i = 0; i < args.size(); i++)
+                args_val[i] = this->evaluate(args[i], context, printer);
+            return apply_builtin(expr->get_kind(), args_val.span(), expr->get_position(), *printer);
         }
-        else if (args_val[0]->get_type() == Type::float_type) {
-            std::string str_repr = std::to_string(args_val[0]->as_float());
-            str_repr = str_repr.substr(0, str_repr.find(".") + 5);
-            return std::make_shared<ReturnValue>(str_repr);
-        }
-        else if (args_val[0]->get_type() == Type::bool_type) {
-            std::string bool_to_str = (args_val[0]->as_bool() == true ? "true" : "false");
-            return std::make_shared<ReturnValue>(bool_to_str);
-        }
-        else if (args_val[0]->get_type() == Type::string_type) {
-            return args_val[0];
-        }
-        else if (args_val[0]->get_type() == Type::null_type) {
-            return std::make_shared<ReturnValue>(
-                std::string("null")
-            ); 
-        }
-    }
-    else if(type == "AdditionExpr") {
-        assert(args_val.size() != 0);
-        Type resultant_type = Type::int_type;
-        float result = 0;
-        for(auto val : args_val) {
-            Type v_type = val->get_type();
-            assert(v_type == Type::float_type || v_type == Type::int_type);
-            if (v_type == Type::float_type)
-                resultant_type = Type::float_type;
-            result += val->as_numerical();
-        }
-        if (resultant_type == Type::int_type) {
-            int result_ = result;
-            return std::make_shared<ReturnValue>(result_); 
-        }
-        return std::make_shared<ReturnValue>(result);
-    }
-    else if(type == "SubtractionExpr") {
-        assert(args_val.size() == 2);
-        Type resultant_type = Type::int_type;
-        for(auto val : args_val) {
-            Type v_type = val->get_type();
-            assert(v_type == Type::float_type || v_type == Type::int_type);
-            if (v_type == Type::float_type)
-                resultant_type = Type::float_type;
-        }
-        float result = args_val[0]->as_numerical() - args_val[1]->as_numerical();
-        if (resultant_type == Type::int_type) {
-            int result_ = result;
-            return std::make_shared<ReturnValue>(result_); 
-        }
-        return std::make_shared<ReturnValue>(result);
-    }
-    else if(type == "MultiplicationExpr") {
-        assert(args_val.size() != 0);
-        Type resultant_type = Type::int_type;
-        float result = 1.0;
-        for(auto val : args_val) {
-            Type v_type = val->get_type();
-            assert(v_type == Type::float_type || v_type == Type::int_type);
-            if (v_type == Type::float_type)
-                resultant_type = Type::float_type;
-            result *= val->as_numerical();
-        }
-        if (resultant_type == Type::int_type) {
-            int result_ = result;
-            return std::make_shared<ReturnValue>(result_); 
-        }
-        return std::make_shared<ReturnValue>(result);
     }
-    else if(type == "DivisionExpr") {
-        assert(args_val.size() == 2);
-        Type resultant_type = Type::int_type;
-        for(auto val : args_val) {
-            Type v_type = val->get_type();
-            assert(v_type == Type::float_type || v_type == Type::int_type);
-            if (v_type == Type::float_type)
-                resultant_type = Type::float_type;
-        }
-        assert(fabs(args_val[1]->as_numerical()) >= 0.0000001);
-        float result = args_val[0]->as_numerical() / args_val[1]->as_numerical();
-        if (resultant_type == Type::int_type) {
-            int result_ = result;
-            return std::make_shared<ReturnValue>(result_); 
+    assert(0);
+    return ReturnValue();
+}
+
+/*
+Same semantics as the tree walker, the node's kind and payload are read from
+the arrays and children are a range of ids.
+*/
+ReturnValue Interpreter::evaluate(
+    const FlatAst& ast,
+    NodeId node,
+    std::shared_ptr<Context> context,
+    std::shared_ptr<Printer> printer
+) {
+    NodeRange args = ast.get_children(node);
+    uint64_t position = ast.get_position(node);
+    switch (ast.get_kind(node)) {
+        case ExprKind::set:
+            context->set_var(ast.get_slot(args[0]), this->evaluate(ast, args[1], context, printer));
+            return ReturnValue();
+        case ExprKind::int_lit:
+            return ReturnValue((int)(ast.get_int(node)));
+        case ExprKind::float_lit:
+            return ReturnValue((float)(ast.get_float(node)));
+        case ExprKind::string_lit:
+            return ReturnValue(std::string(ast.get_string(node)));
+        case ExprKind::bool_lit:
+            return ReturnValue(ast.get_bool(node));
+        case ExprKind::null_lit:
+            return ReturnValue();
+        case ExprKind::identifier:
+            return context->get_var(ast.get_slot(node));
+        case ExprKind::error:
+            for (NodeId arg : args)
+                this->evaluate(ast, arg, context, printer);
+            check(false, position);
+            break;
+        case ExprKind::program:
+            for (NodeId arg : args)
+                this->evaluate(ast, arg, context, printer);
+            return ReturnValue();
+        default: {
+            OperandBuffer args_val(args.size());
+            for (size_t i = 0; i < args.size(); i++)
+                args_val[i] = this->evaluate(ast, args[i], context, printer);
+            return apply_builtin(ast.get_kind(node), args_val.span(), position, *printer);
         }
-        return std::make_shared<ReturnValue>(result);
     }
-    else if(type == "GreaterThanExpr") {
-        assert(args_val.size() == 2);
-        for(auto val : args_val) {
-            Type v_type = val->get_type();
-            assert(v_type == Type::float_type || v_type == Type::int_type);
+    assert(0);
+    return ReturnValue();
+}
+
+void Interpreter::run(Expr* root, AstArena& arena, std::shared_ptr<Context> context, std::shared_ptr<Printer> printer) {
+    NameAnalyzer(arena, context->get_symbol_table()).analyze(root);
+    context->allocate_slots();
+    TypeChecker(arena, *context).check(root);
+    switch (evaluator) {
+        case Evaluator::tree_walker:
+            evaluate(root, context, printer);
+            break;
+        case Evaluator::flat_ast: { // a copy of the analyzed tree, for evaluation only
+            FlatAst ast(root);
+            evaluate(ast, ast.root(), context, printer);
+            break;
         }
-        bool result = args_val[0]->as_numerical() > args_val[1]->as_numerical();
-        return std::make_shared<ReturnValue>((bool)(result));
+        case Evaluator::stack_vm:
+            StackVM().run(BytecodeCompiler().compile(root), context, printer);
+            break;
+        case Evaluator::register_vm:
+            RegisterVM().run(RegisterCompiler().compile(root), context, printer);
+            break;
     }
-    else if(type == "LowerThanExpr") {
-        assert(args_val.size() == 2);
-        for(auto val : args_val) {
-            Type v_type = val->get_type();
-            assert(v_type == Type::float_type || v_type == Type::int_type);
-        }
-        bool result = args_val[0]->as_numerical() < args_val[1]->as_numerical();
-        return std::make_shared<ReturnValue>((bool)(result));
+}
+
+std::string Interpreter::interpret(std::string input) {
+    std::shared_ptr<Context> context = std::make_shared<Context>();
+    std::shared_ptr<Printer> printer = std::make_shared<Printer>();
+    try {
+        TokenStream tokens = lexer.run_parallel(input); // the serial lexer below a few MB
+        AstArena arena;
+        Expr* ast_root = parser.parse(tokens, arena);
+        run(ast_root, arena, context, printer);
     }
-    else if(type == "EqualExpr") {
-        assert(args_val.size() == 2);
-        std::shared_ptr<ReturnValue> left_operand = args_val[0];
-        std::shared_ptr<ReturnValue> right_operand = args_val[1];
-        bool result = false;
-        if (left_operand->is_numerical() && right_operand->is_numerical()) {
-            result = (fabs(left_operand->as_numerical() - right_operand->as_numerical()) < 0.000001);
-        }
-        else if (left_operand->get_type() == right_operand->get_type()) {
-            if (left_operand->get_type() == Type::string_type) {
-                result = (left_operand->as_string() == right_operand->as_string());
-            }
-            else if(left_operand->get_type() == Type::null_type) {
-                result = true;
-            }
-            else if(left_operand->get_type() == Type::bool_type) {
-                result = (left_operand->as_bool() == right_operand->as_bool());
-            }
-            else {
-                assert(0); 
-            }
-        }
-        else {
-            result = false;
-        }
-        return std::make_shared<ReturnValue>((bool)(result));
+    catch (const ProgramError& error) {
+        report_error(LineIndex(input).line_of(error.get_position()), printer);
     }
-    else if(type == "NotEqualExpr") {
-        assert(args_val.size() == 2);
-        std::shared_ptr<ReturnValue> left_operand = args_val[0];
-        std::shared_ptr<ReturnValue> right_operand = args_val[1];
-        bool result = false;
-        if (left_operand->is_numerical() && right_operand->is_numerical()) {
-            result = (fabs(left_operand->as_numerical() - right_operand->as_numerical()) < 0.000001);
-        }
-        else if (left_operand->get_type() == right_operand->get_type()) {
-            if (left_operand->get_type() == Type::string_type) {
-                result = (left_operand->as_string() == right_operand->as_string());
-            }
-            else if(left_operand->get_type() == Type::null_type) {
-                result = true;
-            }
-            else if(left_operand->get_type() == Type::bool_type) {
-                result = (left_operand->as_bool() == right_operand->as_bool());
-            }
-            else {
-                assert(0); 
+    return printer->to_string();
+}
+
+void Interpreter::report_error(size_t line, std::shared_ptr<Printer> printer) {
+    printer->add_output("ERROR at line " + std::to_string(line));
+}
+
+/*
+Top-level expressions are separated by spaces at depth 0 (Program -> Expression Program').
+Each one is copied out of the lexer window with rebased positions and parsed on its own,
+so only the expression being evaluated is kept in memory.
+*/
+void Interpreter::interpret_stream(std::istream& input, std::ostream& output, size_t chunk_size) {
+    std::shared_ptr<Context> context = std::make_shared<Context>();
+    std::shared_ptr<Printer> printer = std::make_shared<Printer>();
+    StreamingLexer stream(input, chunk_size);
+    std::string source;
+    std::vector<Token> expression;
+    AstArena arena; // reused by every expression
+    size_t expression_line = 1;
+    int depth = 0;
+    Token token;
+    try {
+        while (stream.next(token)) {
+            bool expression_end = (token.kind == TokenKind::eof || (token.kind == TokenKind::space && depth == 0));
+            if (!expression_end) {
+                if (expression.empty())
+                    expression_line = stream.line_of(token.position);
+                if (token.kind == TokenKind::delimiter)
+                    depth += (stream.get_lexeme(token) == "(" ? 1 : -1);
+                std::string_view lexeme = stream.get_lexeme(token);
+                token.position = source.size();
+                source += lexeme;
+                expression.push_back(token);
+                if (depth >= 0)
+                    continue;
+                // A stray ')' never ends: the expression can't parse, report it now
+                // instead of reading the rest of the input into it.
             }
-        }
-        else {
-            result = false;
-        }
-        return std::make_shared<ReturnValue>((bool)(!result));        
-    }
-    else if(type == "MinExpr") {
-        assert(args_val.size() > 0);
-        Type resultant_type = Type::int_type;
-        float result = 2e9;
-        for(auto val : args_val) {
-            Type v_type = val->get_type();
-            assert(v_type == Type::float_type || v_type == Type::int_type);
-            if (v_type == Type::float_type)
-                resultant_type = Type::float_type;
-            result = std::min(result, val->as_numerical());
-        }
-        if (resultant_type == Type::int_type) {
-            int result_ = result;
-            return std::make_shared<ReturnValue>(result_); 
-        }
-        return std::make_shared<ReturnValue>(result);
-    }
-    else if(type == "MaxExpr") {
-        assert(args_val.size() > 0);
-        Type resultant_type = Type::int_type;
-        float result = -2e9;
-        for(auto val : args_val) {
-            Type v_type = val->get_type();
-            assert(v_type == Type::float_type || v_type == Type::int_type);
-            if (v_type == Type::float_type)
-                resultant_type = Type::float_type;
-            result = std::max(result, val->as_numerical());
-        }
-        if (resultant_type == Type::int_type) {
-            int result_ = result;
-            return std::make_shared<ReturnValue>(result_); 
-        }
-        return std::make_shared<ReturnValue>(result);   
-    }
-    else if(type == "AbsExpr") {
-        assert(args_val.size() == 1);
-        std::shared_ptr<ReturnValue> operand = args_val[0];
-        Type resultant_type = Type::int_type;
-        for(auto val : args_val) {
-            assert(val->is_numerical());
-            if (val->get_type() == Type::float_type)
-                resultant_type = Type::float_type;
-        }
-        float result = std::fabs(operand->as_numerical());
-        if (resultant_type == Type::int_type) {
-            int result_ = result;
-            return std::make_shared<ReturnValue>(result_); 
-        }
-        return std::make_shared<ReturnValue>(result);      
-    } 
-    else if(type == "ConcatenationExpr") {
-        assert(args_val.size() == 2);
-        std::shared_ptr<ReturnValue> left_operand = args_val[0];
-        std::shared_ptr<ReturnValue> right_operand = args_val[1];
-        assert(left_operand->get_type() == Type::string_type);
-        assert(right_operand->get_type() == Type::string_type);
-        std::string result = left_operand->as_string() + right_operand->as_string();
-        return std::make_shared<ReturnValue>(result);  
-    }
-    else if(type == "ReplacementExpr") {
-        assert(args_val.size() == 3);
-        std::shared_ptr<ReturnValue> target = args_val[0];
-        std::shared_ptr<ReturnValue> replaced = args_val[1];
-        std::shared_ptr<ReturnValue> replacement = args_val[2];
-        assert(target->get_type() == Type::string_type);
-        assert(replaced->get_type() == Type::string_type);
-        assert(replacement->get_type() == Type::string_type);
-        std::string target_str = target->as_string(), replaced_str = replaced->as_string();
-        std::string replacement_str = replacement->as_string();        
-        std::string result;
-        for(int i = 0; i < target->as_string().size();) {
-            if(target_str.substr(i, replaced_str.size()) == replaced_str) {
-                result += replacement_str;
-                i += replaced_str.size();
+            TokenStream tokens(source);
+            for (const Token& expression_token : expression)
+                tokens.push_back(expression_token);
+            tokens.push_back(TokenCreator()(TokenKind::eof, source.size(), 0));
+            try {
+                run(parser.parse(tokens, arena), arena, context, printer);
             }
-            else {
-                result += target_str[i];
-                i++;
+            catch (const ProgramError& error) { // positions are relative to the expression
+                report_error(expression_line + LineIndex(source).line_of(error.get_position()) - 1, printer);
+                break;
             }
+            output << printer->to_string();
+            printer->clear_buffer();
+            source.clear();
+            expression.clear();
+            arena.reset();
         }
-        return std::make_shared<ReturnValue>(result); 
-    }
-    else if(type == "SubstringExpr") {
-        assert(args_val.size() == 3);
-        std::shared_ptr<ReturnValue> target = args_val[0];
-        std::shared_ptr<ReturnValue> left_pos = args_val[1];
-        std::shared_ptr<ReturnValue> right_pos = args_val[2];
-        assert(target->get_type() == Type::string_type);
-        assert(left_pos->get_type() == Type::int_type);
-        assert(right_pos->get_type() == Type::int_type);
-        std::string result = target->as_string().substr(left_pos->as_int(), right_pos->as_int() - left_pos->as_int());
-        return std::make_shared<ReturnValue>(result);   
-    }
-    else if(type == "LowercaseExpr") {
-        assert(args_val.size() == 1);
-        std::shared_ptr<ReturnValue> target = args_val[0];
-        assert(target->get_type() == Type::string_type);
-        std::string result;
-        for(auto u : target->as_string()) {
-            result += std::tolower(u);
-        }
-        return std::make_shared<ReturnValue>(result);     
     }
-    else if(type == "UppercaseExpr") {
-        assert(args_val.size() == 1);
-        std::shared_ptr<ReturnValue> target = args_val[0];
-        assert(target->get_type() == Type::string_type);
-        std::string result;
-        for(auto u : target->as_string()) {
-            result += std::toupper(u);
-        }
-        return std::make_shared<ReturnValue>(result);
-    }
-    else if(type == "IntLiteralExpr") {
-        std::shared_ptr<IntLiteral> int_expr = std::dynamic_pointer_cast<IntLiteral>(expr);
-        return std::make_shared<ReturnValue>((int)(int_expr->get_value()));
-    }
-    else if(type == "FloatLiteralExpr") {
-        std::shared_ptr<FloatLiteral> float_expr = std::dynamic_pointer_cast<FloatLiteral>(expr);
-        return std::make_shared<ReturnValue>((float)(float_expr->get_value()));
-    }
-    else if(type == "StringLiteralExpr") {    
-        std::shared_ptr<StringLiteral> string_expr = std::dynamic_pointer_cast<StringLiteral>(expr);
-        return std::make_shared<ReturnValue>(string_expr->get_value());
+    catch (const ProgramError& error) {
+        report_error(stream.line_of(error.get_position()), printer);
     }
-    else if(type == "BoolLiteralExpr") {
-        std::shared_ptr<BoolLiteral> bool_expr = std::dynamic_pointer_cast<BoolLiteral>(expr);
-        return std::make_shared<ReturnValue>((bool)(bool_expr->get_value()));       
-    }
-    else if(type == "NullLiteralExpr") {
-        return std::make_shared<ReturnValue>();
-    }  
-    else if(type == "IdentifierExpr") {
-        std::shared_ptr<IdentifierExpr> var = std::dynamic_pointer_cast<IdentifierExpr>(expr);
-        return context->get_val(var->get_name());
-    } 
-    else if(type == "ErrorExpr") {
-        assert(0);
-    }
-    else if(type == "ParseTempExpr") {
-        return std::make_shared<ReturnValue>();
-    }             
-    assert(0);
-}
-
-std::string Interpreter::interpret(std::string input) {
-    std::shared_ptr<Context> context = std::make_shared<Context>();
-    std::shared_ptr<Printer> printer = std::make_shared<Printer>();
-    std::vector<std::shared_ptr<Token>> tokens = lexer.run(input);
-    std::shared_ptr<Expr> ast_root = parser.parse(tokens);
-    evaluate(ast_root, context, printer);
-    return printer->to_string();
+    output << printer->to_string();
+    printer->clear_buffer();
+    output.flush();
 }
 
 void Interpreter::repl_iteration(std::string input, std::shared_ptr<Context> context, std::shared_ptr<Printer> printer) {
-    std::vector<std::shared_ptr<Token>> tokens = lexer.run(input);
-    std::shared_ptr<Expr> ast_root = parser.parse(tokens);
-    evaluate(ast_root, context, printer);
+    try {
+        TokenStream tokens = lexer.run(input);
+        AstArena arena;
+        Expr* ast_root = parser.parse(tokens, arena);
+        run(ast_root, arena, context, printer);
+    }
+    catch (const ProgramError& error) {
+        context->discard_unset();
+        report_error(LineIndex(input).line_of(error.get_position()), printer);
+    }
     std::cout << printer->to_string();
     printer->clear_buffer();
 }
@@ -3,77 +3,103 @@
 
 #include <memory>
 #include <map>
-#include <variant>
+#include <cassert>
+#include <string_view>
 #include "../ast/tree_module.h"
+#include "../ast/flat_ast.h"
 #include "../parser/parser.h"
 #include "../lexer/lexer.h"
-
-
-enum class Type {
-    int_type,
-    string_type,
-    null_type,
-    bool_type,
-    float_type,
-    error_type
-};
-
-using ValueType = std::variant<int, float, std::string, bool>;
-
-
+#include "../lexer/streaming_lexer.h"
+#include "../../utils/line_index.h"
+#include "../../utils/program_error.h"
+#include "../name_analyzer/symbol_table.h"
+#include "shared_string.h"
+
+
+/*
+Value of an expression, 16 bytes and passed by value. Numbers and bools are
+stored in place, so arithmetic and comparisons never allocate; strings are a
+SharedString, copying one only bumps its reference count.
+Ints stay 32-bit like the baseline's: literal tokens hold 64 bits, but the
+ones out of the int range are rejected when the AST is built (mapper.cpp),
+so the evaluators can narrow them without checking.
+*/
 class ReturnValue {
     private:
         Type type;
-        ValueType data;
+        union {
+            int int_value;
+            float float_value;
+            bool bool_value;
+        };
+        SharedString string_value;
     public:
-        ReturnValue();
+        ReturnValue() : type(Type::null_type), int_value(0) { }
 
-        ReturnValue(int val);
+        ReturnValue(int val) : type(Type::int_type), int_value(val) { }
 
-        ReturnValue(float val);
+        ReturnValue(float val) : type(Type::float_type), float_value(val) { }
 
-        ReturnValue(std::string val);
+        ReturnValue(bool val) : type(Type::bool_type), bool_value(val) { }
 
-        ReturnValue(bool val);
+        ReturnValue(std::string val) : type(Type::string_type), int_value(0), string_value(std::move(val)) { }
 
-        int as_int() const;
+        ReturnValue(SharedString val) : type(Type::string_type), int_value(0), string_value(std::move(val)) { }
 
-        float as_float() const;
-        
-        std::string as_string() const;
-        
-        bool as_bool() const;
+        ReturnValue(const char* val) = delete; // would silently be a bool
 
-        float as_numerical() const;
+        int as_int() const { assert(type == Type::int_type); return int_value; }
 
-        bool is_numerical() const;
+        float as_float() const { assert(type == Type::float_type); return float_value; }
 
-        Type get_type();
-};
+        // Valid as long as the value (or a copy of it) is.
+        std::string_view as_string() const { assert(type == Type::string_type); return string_value.view(); }
 
-class SymbolTable {
-    private:
-        std::map<std::string, std::shared_ptr<ReturnValue>> symbol_table;
-        
-    public:
-        void add(std::string var_name, std::shared_ptr<ReturnValue> value);
+        const SharedString& as_shared_string() const { assert(type == Type::string_type); return string_value; }
 
-        std::shared_ptr<ReturnValue> get(std::string var_name);
+        bool as_bool() const { assert(type == Type::bool_type); return bool_value; }
 
-        Type get_type(std::string var_name);
+        float as_numerical() const {
+            assert(type == Type::float_type || type == Type::int_type);
+            return type == Type::float_type ? float_value : int_value;
+        }
+
+        bool is_numerical() const { return type == Type::float_type || type == Type::int_type; }
+
+        Type get_type() const { return type; }
 };
 
+static_assert(sizeof(ReturnValue) == 16, "values are passed by value, keep them small");
+static_assert(sizeof(int) == sizeof(int32_t), "int literals are range checked against 32-bit ints");
+
+/*
+Values of the variables, indexed by the slots the NameAnalyzer gave them in
+the symbol table. Reading or setting a variable is one array access.
+*/
 class Context {
     private:
         SymbolTable symbol_table;
+        std::vector<ReturnValue> values;
+        size_t set_count = 0; // sets run in slot order: the slots below this one are set
     public:
-        Context();
+        SymbolTable& get_symbol_table() { return symbol_table; }
 
-        void insert_var(std::string var_name, std::shared_ptr<ReturnValue> value);
+        // Makes room for the slots added to the symbol table since the last call.
+        void allocate_slots() { values.resize(symbol_table.size()); }
 
-        Type get_type(std::string var_name);
+        void set_var(uint32_t slot, ReturnValue value) {
+            values[slot] = std::move(value);
+            set_count = slot + 1;
+        }
 
-        std::shared_ptr<ReturnValue> get_val(std::string var_name);
+        // The analyzer made sure the variable is set by the time it's read.
+        const ReturnValue& get_var(uint32_t slot) const { return values[slot]; }
+
+        size_t get_slot_count() const { return values.size(); }
+
+        // After an error, forgets the variables whose set didn't run, so a
+        // later program (in the REPL) may still set them.
+        void discard_unset();
 };
 
 class Printer {
@@ -87,22 +113,53 @@ class Printer {
         std::string to_string();
 };
 
+// The engine programs are run with, all of them produce the same output.
+enum class Evaluator : uint8_t {
+    tree_walker, // recursive evaluation of the Expr tree
+    flat_ast, // recursive evaluation over the FlatAst arrays
+    stack_vm, // compiled to Bytecode and run by the StackVM
+    register_vm // compiled to RegisterCode and run by the RegisterVM
+};
+
 class Interpreter { // static (?)
     private:
         Lexer lexer;
 
         Parser parser;
+
+        Evaluator evaluator;
+
+        // Analyzes the names and the types of the program, then evaluates it.
+        void run(Expr* root, AstArena& arena, std::shared_ptr<Context> context, std::shared_ptr<Printer> printer);
+
+        void report_error(size_t line, std::shared_ptr<Printer> printer);
     public:
-        Interpreter();
+        Interpreter(Evaluator evaluator = Evaluator::tree_walker);
 
-        std::shared_ptr<ReturnValue> evaluate(
-            std::shared_ptr<Expr> expr_eval, 
+        // The names of the expression must be resolved with a NameAnalyzer on
+        // the symbol table of context (run does it), its types may be checked.
+        ReturnValue evaluate(
+            Expr* expr_eval, 
             std::shared_ptr<Context> context, 
             std::shared_ptr<Printer> printer
         );
 
+        ReturnValue evaluate(
+            const FlatAst& ast,
+            NodeId node,
+            std::shared_ptr<Context> context,
+            std::shared_ptr<Printer> printer
+        );
+
         std::string interpret(std::string input);
 
+        // Lexes the input in chunks and runs it one top-level expression at a time,
+        // output is written as soon as each expression is evaluated. Unlike
+        // interpret, a lexing or parsing error is only found once the stream
+        // reaches it: the expressions before it have already run and printed
+        // their output, then the error is reported.
+        void interpret_stream(std::istream& input, std::ostream& output, size_t chunk_size = StreamingLexer::default_chunk_size);
+
         void repl_iteration(std::string input, std::shared_ptr<Context> context, std::shared_ptr<Printer> printer);
 };
 
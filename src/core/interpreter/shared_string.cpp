@@ -0,0 +1,129 @@
+#include <algorithm>
+#include <cassert>
+#include <vector>
+
+#include "shared_string.h"
+
+SharedString::SharedString(std::string text)
+    : node(new Node{1, nullptr, 0, nullptr, nullptr, nullptr, 0, 1, std::move(text)}) {
+    node->data = node->text.data();
+    node->size = node->text.size();
+}
+
+// Recurses as deep as the rope at most, which rebalancing keeps shallow.
+void SharedString::release(Node* node) {
+    if (node && --node->references == 0) {
+        release(node->base);
+        release(node->left);
+        release(node->right);
+        delete node;
+    }
+}
+
+// Copies the leaves in order into the node's own buffer, the operands aren't
+// needed anymore. Ropes containing the node keep their depth, an overestimate.
+void SharedString::flatten(Node* node) {
+    std::string text;
+    text.reserve(node->size);
+    std::vector<Node*> pending = {node};
+    while (!pending.empty()) {
+        Node* current = pending.back();
+        pending.pop_back();
+        if (current->data) {
+            text.append(current->data, current->size);
+            continue;
+        }
+        pending.push_back(current->right);
+        pending.push_back(current->left);
+    }
+    node->text = std::move(text);
+    node->data = node->text.data();
+    node->depth = 0;
+    node->leaves = 1;
+    release(node->left);
+    release(node->right);
+    node->left = nullptr;
+    node->right = nullptr;
+}
+
+SharedString::Node* SharedString::make_rope(Node* left, Node* right) {
+    return new Node{
+        1, nullptr, left->size + right->size, nullptr, left, right,
+        1 + std::max(left->depth, right->depth), left->leaves + right->leaves, std::string()
+    };
+}
+
+// At most twice as deep as a perfectly balanced rope with as many leaves.
+bool SharedString::is_balanced(const Node* node) {
+    return node->depth < 2 || (node->depth / 2 < 64 && (size_t(1) << (node->depth / 2)) <= node->leaves);
+}
+
+/*
+A new rope over the same bytes as root, sharing its balanced subtrees whole:
+rebalancing a rope that only grew by a few pieces since the last time costs
+about as many steps as there are new pieces, not as there are leaves.
+*/
+SharedString::Node* SharedString::rebalance(Node* root) {
+    std::vector<Node*> units;
+    std::vector<Node*> pending = {root->right, root->left}; // the root itself is always split
+    while (!pending.empty()) {
+        Node* current = pending.back();
+        pending.pop_back();
+        if (is_balanced(current)) {
+            units.push_back(current);
+            continue;
+        }
+        pending.push_back(current->right);
+        pending.push_back(current->left);
+    }
+    return build_balanced(units.data(), units.size());
+}
+
+// Splits the units where the leaves on both sides are closest to even.
+SharedString::Node* SharedString::build_balanced(Node* const* units, size_t count) {
+    if (count == 1) {
+        units[0]->references++;
+        return units[0];
+    }
+    size_t total_leaves = 0;
+    for (size_t i = 0; i < count; i++)
+        total_leaves += units[i]->leaves;
+    size_t split = 1;
+    size_t left_leaves = units[0]->leaves;
+    while (split + 1 < count && 2 * (left_leaves + units[split]->leaves) <= total_leaves)
+        left_leaves += units[split++]->leaves;
+    return make_rope(build_balanced(units, split), build_balanced(units + split, count - split));
+}
+
+SharedString SharedString::substring(size_t offset, size_t length) const {
+    assert(offset + length <= size());
+    if (offset == 0 && length == size())
+        return *this;
+    std::string_view bytes = view();
+    if (length < min_slice_size)
+        return SharedString(std::string(bytes.substr(offset, length)));
+    Node* base = node->base ? node->base : node; // slices of slices share the original bytes
+    base->references++;
+    return SharedString(new Node{1, bytes.data() + offset, length, base, nullptr, nullptr, 0, 1, std::string()});
+}
+
+SharedString SharedString::concat(const SharedString& left, const SharedString& right) {
+    if (left.size() == 0)
+        return right;
+    if (right.size() == 0)
+        return left;
+    size_t size = left.size() + right.size();
+    if (size <= max_flat_concat_size) {
+        std::string text;
+        text.reserve(size);
+        text += left.view();
+        text += right.view();
+        return SharedString(std::move(text));
+    }
+    left.node->references++;
+    right.node->references++;
+    SharedString result(make_rope(left.node, right.node));
+    if (result.node->depth > max_rope_depth)
+        return SharedString(rebalance(result.node));
+    return result;
+}
@@ -0,0 +1,113 @@
+#ifndef SHARED_STRING_H
+#define SHARED_STRING_H
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+/*
+Immutable string shared by reference counting: copying one increments a
+counter, the bytes themselves are never copied. A substring is a slice
+pointing into the bytes of the string it was taken from, which it keeps
+alive. A concatenation is a rope node over its two operands, its bytes are
+only assembled the first time they're viewed. Values only live on the thread
+running the program, so the counter isn't atomic.
+*/
+class SharedString {
+    private:
+        struct Node {
+            size_t references;
+            const char* data; // into text, or into the bytes of base for a slice, nullptr until a rope is flattened
+            size_t size;
+            Node* base; // the node owning the bytes of a slice, nullptr otherwise
+            Node* left; // the operands of a rope that isn't flattened yet
+            Node* right;
+            size_t depth; // of the rope, 0 for nodes holding their bytes
+            size_t leaves; // of the rope, 1 for nodes holding their bytes
+            std::string text;
+        };
+
+        // Slices shorter than this are copied: as cheap as creating the slice
+        // node, and they don't keep a large string alive.
+        static constexpr size_t min_slice_size = 16;
+
+        // Concatenations up to this size are copied into a single buffer.
+        static constexpr size_t max_flat_concat_size = 64;
+
+        // Ropes deeper than this are rebalanced.
+        static constexpr size_t max_rope_depth = 48;
+
+        Node* node = nullptr; // nullptr is the empty string
+
+        explicit SharedString(Node* node) : node(node) { }
+
+        static void release(Node* node);
+
+        static void flatten(Node* node);
+
+        // Takes over a reference to left and right.
+        static Node* make_rope(Node* left, Node* right);
+
+        static bool is_balanced(const Node* node);
+
+        static Node* rebalance(Node* root);
+
+        static Node* build_balanced(Node* const* units, size_t count);
+
+    public:
+        SharedString() = default;
+
+        SharedString(std::string text);
+
+        SharedString(const SharedString& other) : node(other.node) {
+            if (node)
+                node->references++;
+        }
+
+        SharedString(SharedString&& other) noexcept : node(other.node) {
+            other.node = nullptr;
+        }
+
+        SharedString& operator=(const SharedString& other) {
+            if (other.node)
+                other.node->references++;
+            release(node);
+            node = other.node;
+            return *this;
+        }
+
+        SharedString& operator=(SharedString&& other) noexcept {
+            if (this != &other) {
+                release(node);
+                node = other.node;
+                other.node = nullptr;
+            }
+            return *this;
+        }
+
+        ~SharedString() {
+            release(node);
+        }
+
+        // Flattens a rope the first time.
+        std::string_view view() const {
+            if (!node)
+                return std::string_view();
+            if (!node->data)
+                flatten(node);
+            return std::string_view(node->data, node->size);
+        }
+
+        size_t size() const {
+            return node ? node->size : 0;
+        }
+
+        // The bytes [offset, offset + length), which must be in the string. Doesn't
+        // copy them unless the slice is very short.
+        SharedString substring(size_t offset, size_t length) const;
+
+        // O(1) unless the result is short or the rope gets too deep.
+        static SharedString concat(const SharedString& left, const SharedString& right);
+};
+
+#endif // SHARED_STRING_H
@@ -0,0 +1,127 @@
+#ifndef KEYWORDS_H
+#define KEYWORDS_H
+
+#include <array>
+#include <cstdint>
+#include <string_view>
+
+/*
+The single table of reserved words. The lexer classifies identifier-like
+runs with it and ExprCreator dispatches builtin calls on its Keyword ids,
+so a builtin can't be known to one of them and not the other.
+*/
+
+enum class Keyword : uint8_t {
+    add,
+    set,
+    puts,
+    concat,
+    lowercase,
+    uppercase,
+    replace,
+    substring,
+    subtract,
+    multiply,
+    divide,
+    abs,
+    min,
+    max,
+    gt,
+    lt,
+    equal,
+    not_equal,
+    str,
+    none // null, false and true are reserved words but not keywords
+};
+
+enum class ReservedWordKind : uint8_t {
+    keyword,
+    null_lit,
+    bool_lit
+};
+
+struct ReservedWord {
+    std::string_view text;
+    ReservedWordKind kind;
+    Keyword keyword;
+};
+
+constexpr ReservedWord reserved_words[] = {
+    {"add", ReservedWordKind::keyword, Keyword::add},
+    {"set", ReservedWordKind::keyword, Keyword::set},
+    {"puts", ReservedWordKind::keyword, Keyword::puts},
+    {"concat", ReservedWordKind::keyword, Keyword::concat},
+    {"lowercase", ReservedWordKind::keyword, Keyword::lowercase},
+    {"uppercase", ReservedWordKind::keyword, Keyword::uppercase},
+    {"replace", ReservedWordKind::keyword, Keyword::replace},
+    {"substring", ReservedWordKind::keyword, Keyword::substring},
+    {"subtract", ReservedWordKind::keyword, Keyword::subtract},
+    {"multiply", ReservedWordKind::keyword, Keyword::multiply},
+    {"divide", ReservedWordKind::keyword, Keyword::divide},
+    {"abs", ReservedWordKind::keyword, Keyword::abs},
+    {"min", ReservedWordKind::keyword, Keyword::min},
+    {"max", ReservedWordKind::keyword, Keyword::max},
+    {"gt", ReservedWordKind::keyword, Keyword::gt},
+    {"lt", ReservedWordKind::keyword, Keyword::lt},
+    {"equal", ReservedWordKind::keyword, Keyword::equal},
+    {"not_equal", ReservedWordKind::keyword, Keyword::not_equal},
+    {"str", ReservedWordKind::keyword, Keyword::str},
+    {"null", ReservedWordKind::null_lit, Keyword::none},
+    {"false", ReservedWordKind::bool_lit, Keyword::none},
+    {"true", ReservedWordKind::bool_lit, Keyword::none}
+};
+
+constexpr int reserved_words_count = sizeof(reserved_words) / sizeof(reserved_words[0]);
+
+constexpr size_t max_reserved_word_length() {
+    size_t result = 0;
+    for (const ReservedWord& word : reserved_words)
+        result = word.text.size() > result ? word.text.size() : result;
+    return result;
+}
+
+// Perfect hash over the reserved words: length, first and last character.
+// The constants were picked so the 22 words land in distinct slots, which is
+// checked at compile time below.
+constexpr size_t reserved_word_slots = 64;
+
+constexpr size_t reserved_word_hash(std::string_view word) {
+    return (word.size() + 2 * size_t(uint8_t(word.front())) + 16 * size_t(uint8_t(word.back()))) % reserved_word_slots;
+}
+
+constexpr std::array<int8_t, reserved_word_slots> build_reserved_word_slots() {
+    std::array<int8_t, reserved_word_slots> slots{};
+    for (size_t slot = 0; slot < reserved_word_slots; slot++)
+        slots[slot] = -1;
+    for (int index = 0; index < reserved_words_count; index++) {
+        size_t slot = reserved_word_hash(reserved_words[index].text);
+        slots[slot] = slots[slot] == -1 ? int8_t(index) : int8_t(-2); // -2 marks a collision
+    }
+    return slots;
+}
+
+constexpr std::array<int8_t, reserved_word_slots> reserved_word_table = build_reserved_word_slots();
+
+constexpr bool reserved_word_hash_is_perfect() {
+    int used = 0;
+    for (int8_t slot : reserved_word_table) {
+        if (slot == -2)
+            return false;
+        used += slot >= 0;
+    }
+    return used == reserved_words_count;
+}
+
+static_assert(reserved_word_hash_is_perfect(), "reserved_word_hash has collisions, pick other constants");
+
+// The reserved word spelled by word, nullptr if it's not one.
+constexpr const ReservedWord* find_reserved_word(std::string_view word) {
+    if (word.empty() || word.size() > max_reserved_word_length())
+        return nullptr;
+    int8_t index = reserved_word_table[reserved_word_hash(word)];
+    if (index < 0 || reserved_words[index].text != word)
+        return nullptr;
+    return &reserved_words[index];
+}
+
+#endif // KEYWORDS_H
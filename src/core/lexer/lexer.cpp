@@ -1,94 +1,326 @@
-#include <regex>
+#include <algorithm>
 #include <cassert>
-#include <stdexcept>
+#include <atomic>
+#include <charconv>
+#include <exception>
 #include <iostream>
+#include <thread>
 #include "lexer.h"
 #include "tokens.h"
+#include "../../utils/program_error.h"
 
 
-Rule::Rule(std::regex premise, std::string token_type) : premise(std::move(premise)), token_type(std::move(token_type)) {
-    return;
+namespace {
+
+constexpr int accepted(TokenKind kind) {
+    return int(kind);
 }
 
-std::regex Rule::get_regex() {
-    return premise;
+bool is_whitespace(char c) {
+    return c == ' ' || (c >= '\t' && c <= '\r');
 }
 
-std::string Rule::get_token_type() {
-    return token_type;
+bool is_lowercase_letter(char c) {
+    return c >= 'a' && c <= 'z';
 }
 
+bool is_letter(char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+}
 
-Lexer::Lexer() {     
-    lexer_rules.push_back(Rule(std::regex("^(\\(|\\))"), "DelimiterToken"));
-    
-    std::regex keywords("^((add)|(set)|(puts)|(concat)|(lowercase)"
-                    "|(uppercase)|(replace)"
-                    "|(substring)|(subtract)|(multiply)"
-                    "|(divide)|(abs)|(min)|(max)|(gt)|(lt)|(equal)|(not_equal)|(str))");
-    lexer_rules.push_back(Rule(keywords, "KeywordToken"));
-    
-    lexer_rules.push_back(Rule(std::regex("^(null)"), "NullLitToken"));
-    lexer_rules.push_back(Rule(std::regex("^((0)|(-?[1-9][0-9]*))"), "IntLitToken"));
-    lexer_rules.push_back(Rule(std::regex("^((0)|(-?[1-9][0-9]*)\\.([0-9]*))"), "FloatLitToken"));
-    lexer_rules.push_back(Rule(std::regex("^(\"([^\"])*\")"), "StringLitToken"));
-    lexer_rules.push_back(Rule(std::regex("^((false)|(true))"), "BoolLitToken"));
-    
-    lexer_rules.push_back(Rule(std::regex("^([a-z]([a-z]|[A-Z])*)"), "IdentifierToken"));
-    lexer_rules.push_back(Rule(std::regex("^\\s"), "SpaceToken"));                
+// Decodes the numeric literal [begin, end) straight from the source,
+// literals out of the range of T make the program incorrect.
+template <typename T>
+T decode_number(std::string_view input, size_t begin, size_t end) {
+    T value = 0;
+    auto [parsed_end, error] = std::from_chars(input.data() + begin, input.data() + end, value);
+    if (error != std::errc() || parsed_end != input.data() + end)
+        throw ProgramError(begin);
+    return value;
 }
 
-std::vector<std::shared_ptr<Token>> Lexer::run(std::string input) {
-    // works in O(|Rules| * n^2), we can do it faster
-    std::vector<std::shared_ptr<Token>> tokens;  
-    while(input.size()) {
-        std::string longest_match_name = "None";
-        int longest_match_size = -1;
-        for(auto& rule : lexer_rules) {
-            std::smatch rule_match;
-            if (regex_search(input, rule_match, rule.get_regex(), std::regex_constants::match_continuous) 
-                && int(rule_match.length()) > longest_match_size) {
-                longest_match_name = rule.get_token_type();
-                longest_match_size = rule_match.length();
-            }
+constexpr std::string_view digits = "0123456789";
+constexpr std::string_view whitespaces = " \t\n\v\f\r";
+
+// The scanner table only depends on the token rules, it's built at compile time.
+constexpr ScannerTable build_scanner_table() {
+    ScannerTable table;
+    int start = table.add_state(-1);
+    assert(start == ScannerTable::start_state);
+
+    // (|)
+    int delimiter = table.add_state(accepted(TokenKind::delimiter));
+    table.add_transitions(start, "()", delimiter);
+
+    // \s+, the whole run collapses into a single SpaceToken anyway
+    int space = table.add_state(accepted(TokenKind::space));
+    table.add_transitions(start, whitespaces, space);
+    table.add_transitions(space, whitespaces, space);
+
+    // " + (not("))* + "
+    int string_body = table.add_state(-1);
+    int string_end = table.add_state(accepted(TokenKind::string_lit));
+    table.add_transition(start, '"', string_body);
+    for (int symbol = 0; symbol < 256; symbol++) {
+        if (symbol != '"')
+            table.add_transition(string_body, symbol, string_body);
+    }
+    table.add_transition(string_body, '"', string_end);
+
+    // 0 | -?[1-9][0-9]* and -?[1-9][0-9]* + '.' + [0-9]*
+    const int int_id = accepted(TokenKind::int_lit), float_id = accepted(TokenKind::float_lit);
+    int zero = table.add_state(int_id);
+    int minus = table.add_state(-1);
+    int integer = table.add_state(int_id);
+    int fraction = table.add_state(float_id);
+    table.add_transition(start, '0', zero);
+    table.add_transition(start, '-', minus);
+    table.add_transitions(start, digits.substr(1), integer);
+    table.add_transitions(minus, digits.substr(1), integer);
+    table.add_transitions(integer, digits, integer);
+    table.add_transition(integer, '.', fraction);
+    table.add_transitions(fraction, digits, fraction);
+
+    // keywords, null, false | true and identifiers are read by scan_word
+    return table;
+}
+
+constexpr ScannerTable scanner_table = build_scanner_table();
+
+}
+
+
+
+// Lexer
+
+/*
+Identifiers and reserved words: the identifier run [a-z][a-zA-Z]* is read
+once and classified with the perfect hash of keywords.h. A reserved word
+wins over an identifier of the same length (keyword rules come first), and
+only reserved words containing '_' (not_equal) can be longer than the run.
+*/
+inline Token Lexer::scan_word(std::string_view input, size_t pos, bool input_complete) const {
+    size_t word_end = pos;
+    size_t run_end = pos + 1;
+    while (run_end < input.size() && is_letter(input[run_end]))
+        run_end++;
+    if (run_end == input.size() && !input_complete)
+        return Token{};
+
+    const ReservedWord* reserved_word = nullptr;
+    if (run_end < input.size() && input[run_end] == '_') {
+        size_t extended_end = run_end;
+        while (extended_end < input.size() && (is_letter(input[extended_end]) || input[extended_end] == '_'))
+            extended_end++;
+        if (extended_end == input.size() && !input_complete && extended_end - pos <= max_reserved_word_length())
+            return Token{};
+        size_t length = std::min(extended_end - pos, max_reserved_word_length());
+        for (; length > run_end - pos && !reserved_word; length--) {
+            reserved_word = find_reserved_word(input.substr(pos, length));
+            if (reserved_word)
+                word_end = pos + length;
+        }
+    }
+    if (!reserved_word) {
+        reserved_word = find_reserved_word(input.substr(pos, run_end - pos));
+        word_end = run_end;
+    }
+
+    size_t length = word_end - pos;
+    if (!reserved_word) {
+        return token_creator(TokenKind::identifier, pos, length);
+    }
+    else if (reserved_word->kind == ReservedWordKind::keyword) {
+        return token_creator(TokenKind::keyword, reserved_word->keyword, pos, length);
+    }
+    else if (reserved_word->kind == ReservedWordKind::bool_lit) {
+        return token_creator(TokenKind::bool_lit, bool(reserved_word->text == "true"), pos, length);
+    }
+    else {
+        return token_creator(TokenKind::null_lit, pos, length);
+    }
+}
+
+inline Token Lexer::scan_table_token(std::string_view input, size_t pos, bool input_complete) const {
+    int state = ScannerTable::start_state;
+    int match_type = -1;
+    size_t match_end = pos;
+    size_t i = pos;
+    for (; i < input.size(); i++) {
+        state = scanner_table.next(state, input[i]);
+        if (state == ScannerTable::dead_state)
+            break;
+        if (scanner_table.accepted_type(state) != -1) {
+            match_type = scanner_table.accepted_type(state);
+            match_end = i + 1;
+        }
+    }
+    if (i == input.size() && !input_complete)
+        return Token{};
+    if (match_type == -1)
+        throw ProgramError(pos);
+
+    TokenKind kind = TokenKind(match_type);
+    size_t match_size = match_end - pos;
+    if (kind == TokenKind::int_lit) {
+        return token_creator(kind, decode_number<int64_t>(input, pos, match_end), pos, match_size);
+    }
+    else if (kind == TokenKind::float_lit) {
+        return token_creator(kind, decode_number<double>(input, pos, match_end), pos, match_size);
+    }
+    else {
+        return token_creator(kind, pos, match_size);
+    }
+}
+
+/*
+Longest match, first rule. Whitespace runs and string literal bodies, which
+are most of the bytes of a typical program, skip the DFA and go through the
+vectorized scanner, words go through the reserved word hash. The only
+backtracking is to the end of the last accepted prefix, which is bounded by
+the longest keyword.
+*/
+inline Token Lexer::next_token(std::string_view input, size_t pos, bool input_complete) const {
+    if (input[pos] == '"') {
+        size_t closing_quote = byte_scanner.find_quote(input, pos + 1);
+        if (closing_quote == input.size()) {
+            if (!input_complete)
+                return Token{};
+            throw ProgramError(pos);
         }
-        if (longest_match_name == "None")
-            throw std::runtime_error("Incorrect program.");
-        
-        
-        if (longest_match_name  == "IntLitToken") {
-            std::string value = input.substr(0, longest_match_size);
-            tokens.push_back(token_creator(longest_match_name , std::stoi(value), 0));//TODO
-        } 
-        else if (longest_match_name  == "BoolLitToken") {
-            std::string value = input.substr(0, longest_match_size);
-            tokens.push_back(token_creator(longest_match_name , bool(value == "true"), 0));//TODO
+        return token_creator(TokenKind::string_lit, pos, closing_quote + 1 - pos);
+    }
+    if (is_lowercase_letter(input[pos])) {
+        return scan_word(input, pos, input_complete);
+    }
+    if (is_whitespace(input[pos])) {
+        size_t space_end = byte_scanner.skip_whitespace(input, pos);
+        if (space_end == input.size() && !input_complete)
+            return Token{};
+        return token_creator(TokenKind::space, pos, space_end - pos);
+    }
+    return scan_table_token(input, pos, input_complete);
+}
+
+bool Lexer::scan_token(std::string_view input, size_t pos, bool input_complete, Token& token) const {
+    token = next_token(input, pos, input_complete);
+    return token.length != 0;
+}
+
+const ScannerTable& Lexer::default_scanner_table() {
+    return scanner_table;
+}
+
+Lexer::Lexer() : Lexer(ByteScanner::best_supported_level()) { }
+
+Lexer::Lexer(SimdLevel simd_level) : byte_scanner(simd_level) { }
+
+void Lexer::scan_range(std::string_view input, size_t begin, size_t end, std::vector<Token>& tokens) const {
+    input = input.substr(0, end);
+    size_t pos = begin;
+    while (pos < end) {
+        Token token = next_token(input, pos, true);
+        pos += token.length;
+        tokens.push_back(token);
+    }
+}
+
+void Lexer::append_piece(std::vector<Token>& tokens, const std::vector<Token>& piece) {
+    for (const Token& token : piece) {
+        // whitespace runs are a single SpaceToken and can't start or end the program
+        if (token.kind != TokenKind::space || (tokens.size() && tokens.back().kind != TokenKind::space))
+            tokens.push_back(token);
+    }
+}
+
+TokenStream Lexer::finish(std::string_view input, std::vector<Token> tokens) const {
+    while (tokens.size() && tokens.back().kind == TokenKind::space)
+        tokens.pop_back();
+    tokens.push_back(token_creator(TokenKind::eof, input.size(), 0)); // Add EOF Token at the end
+    return TokenStream(input, std::move(tokens));
+}
+
+TokenStream Lexer::run(const std::string& input) const {
+    std::vector<Token> tokens;
+    // a single range has no adjacent spaces, only the leading one has to go
+    scan_range(input, byte_scanner.skip_whitespace(input, 0), input.size(), tokens);
+    return finish(input, std::move(tokens));
+}
+
+/*
+Pre-scan for run_parallel. Only '(', ')' and '"' matter, so the vectorized
+scanner jumps between them and string bodies are skipped whole. A ')' outside
+of a string always ends a token, so cutting right after it can't change the
+tokens on either side; we only cut where it closes a top-level expression.
+*/
+std::vector<size_t> Lexer::split_points(std::string_view input, size_t piece_size) const {
+    std::vector<size_t> points = {0};
+    size_t next_target = piece_size;
+    int depth = 0;
+    size_t pos = 0;
+    while (next_target < input.size()) {
+        pos = byte_scanner.find_paren_or_quote(input, pos);
+        if (pos == input.size())
+            break;
+        if (input[pos] == '"') {
+            pos = byte_scanner.find_quote(input, pos + 1);
+            if (pos == input.size()) // unterminated, the last piece reports it
+                break;
         }
-        else if (longest_match_name  == "FloatLitToken") {
-            std::string value = input.substr(0, longest_match_size);
-            tokens.push_back(token_creator(longest_match_name , std::stof(value), 0));//TODO
+        else if (input[pos] == '(') {
+            depth++;
         }
-        else if (longest_match_name  == "NullLitToken") {
-            tokens.push_back(token_creator(longest_match_name , 0)); //TODO
+        else if (--depth == 0 && pos + 1 >= next_target) {
+            points.push_back(pos + 1);
+            next_target = pos + 1 + piece_size;
         }
-        else if (longest_match_name  == "StringLitToken") {
-            tokens.push_back(token_creator(longest_match_name , input.substr(1, longest_match_size - 2), 0)); // TODO    
-        }        
-        else if(longest_match_name  == "SpaceToken") {
-            if(tokens.size() && tokens.back()->get_type() != "SpaceToken") {
-                tokens.push_back(token_creator(longest_match_name , 0)); //TODO
+        pos++;
+    }
+    points.push_back(input.size());
+    return points;
+}
+
+TokenStream Lexer::run_parallel(const std::string& input, size_t thread_count, size_t min_piece_size) const {
+    if (thread_count == 0)
+        thread_count = std::max(1u, std::thread::hardware_concurrency());
+    if (thread_count == 1 || input.size() < 2 * min_piece_size)
+        return run(input);
+    // a few pieces per thread so that uneven pieces still balance
+    size_t piece_size = std::max(min_piece_size, input.size() / (4 * thread_count) + 1);
+    std::vector<size_t> points = split_points(input, piece_size);
+    size_t piece_count = points.size() - 1;
+
+    std::vector<std::vector<Token>> pieces(piece_count);
+    std::vector<std::exception_ptr> errors(piece_count);
+    std::atomic<size_t> next_piece(0);
+    auto worker = [&]() {
+        for (size_t i = next_piece++; i < piece_count; i = next_piece++) {
+            try {
+                scan_range(input, points[i], points[i + 1], pieces[i]);
+            }
+            catch (...) {
+                errors[i] = std::current_exception();
             }
         }
-        else {
-            tokens.push_back(token_creator(longest_match_name , input.substr(0, longest_match_size), 0)); // TODO
-        }
+    };
+    std::vector<std::thread> threads;
+    for (size_t i = 1; i < std::min(thread_count, piece_count); i++)
+        threads.emplace_back(worker);
+    worker();
+    for (std::thread& thread : threads)
+        thread.join();
 
-        input = input.substr(longest_match_size, input.size() - longest_match_size);
+    size_t token_count = 1;
+    for (size_t i = 0; i < piece_count; i++) {
+        if (errors[i])
+            std::rethrow_exception(errors[i]);
+        token_count += pieces[i].size();
     }
-    while(tokens.size() && tokens.back()->get_type() == "SpaceToken")
-        tokens.pop_back();
-    tokens.push_back(token_creator("EOFToken", 0)); // Add EOF Token at the end
-    return tokens;
+    std::vector<Token> tokens;
+    tokens.reserve(token_count);
+    for (const std::vector<Token>& piece : pieces)
+        append_piece(tokens, piece);
+    return finish(input, std::move(tokens));
 }
 
 
@@ -121,4 +353,4 @@ Rules:
     (a | b | ... | z) + ((a | ... | z | A | ... | Z)*) => IdentifierToken
 */
 
-// longest match, first rule
\ No newline at end of file
+// longest match, first rule
@@ -1,33 +1,101 @@
 #ifndef LEXER_H
 #define LEXER_H
 
-#include <regex>
+#include <array>
+#include <cstdint>
 #include <cassert>
 #include <iostream>
+#include <vector>
 #include "tokens.h"
+#include "../../utils/byte_scanner.h"
 
 
-class Rule {
+// Table driven deterministic scanner. Every state has a row of 256 transitions
+// (one per input byte) and the id of the token type it accepts (-1 if none).
+// Everything is constexpr so that the lexer's table is built at compile time.
+class ScannerTable {
+    public:
+        static constexpr int max_states = 16;
+        static constexpr int dead_state = -1;
+        static constexpr int start_state = 0;
     private:
-        std::regex premise;
-        std::string token_type;
+        std::array<std::array<int, 256>, max_states> transitions{};
+        std::array<int, max_states> accepting{};
+        int state_count = 0;
     public:
-        Rule(std::regex premise, std::string token_type);
-        
-        std::regex get_regex();
+        constexpr int add_state(int accepted_type_id) {
+            assert(state_count < max_states);
+            for (int symbol = 0; symbol < 256; symbol++)
+                transitions[state_count][symbol] = dead_state;
+            accepting[state_count] = accepted_type_id;
+            return state_count++;
+        }
+
+        constexpr void add_transition(int from, unsigned char symbol, int to) {
+            transitions[from][symbol] = to;
+        }
+
+        constexpr void add_transitions(int from, std::string_view symbols, int to) {
+            for (unsigned char symbol : symbols)
+                transitions[from][symbol] = to;
+        }
+
+        constexpr int next(int state, unsigned char symbol) const {
+            return transitions[state][symbol];
+        }
 
-        std::string get_token_type();
+        constexpr int accepted_type(int state) const {
+            return accepting[state];
+        }
 };
 
 
 class Lexer {
     private:
-        std::vector<Rule> lexer_rules;
+        ByteScanner byte_scanner;
         TokenCreator token_creator;
+
+        // The scanners below return the token starting at pos, or an empty token (length 0)
+        // when input_complete is false and the token might continue past the end of input.
+        // They return by value and are inlined into the lexing loop, which is measurably
+        // faster than filling a Token& out parameter.
+        inline Token scan_word(std::string_view input, size_t pos, bool input_complete) const;
+
+        // Delimiters and numbers, longest match of the scanner table.
+        inline Token scan_table_token(std::string_view input, size_t pos, bool input_complete) const;
+
+        inline Token next_token(std::string_view input, size_t pos, bool input_complete) const;
+
+        // Appends the tokens of input[begin, end), a whitespace run is one space token.
+        void scan_range(std::string_view input, size_t begin, size_t end, std::vector<Token>& tokens) const;
+
+        // Piece boundaries for run_parallel: right after a ')' closing a top-level expression.
+        std::vector<size_t> split_points(std::string_view input, size_t piece_size) const;
+
+        // Appends piece to tokens, dropping the spaces that would start the program or follow a space.
+        static void append_piece(std::vector<Token>& tokens, const std::vector<Token>& piece);
+
+        TokenStream finish(std::string_view input, std::vector<Token> tokens) const;
     public:
+        // Built at compile time and shared by all lexers.
+        static const ScannerTable& default_scanner_table();
 
         Lexer();
 
-        std::vector<std::shared_ptr<Token>> run(std::string input);
+        // Restricts the vectorized fast paths to the given level (for benchmarking).
+        Lexer(SimdLevel simd_level);
+
+        // The stream references the input, it must outlive the returned tokens.
+        TokenStream run(const std::string& input) const;
+
+        // Scans the token starting at pos into token (position relative to input).
+        // When input_complete is false and the token might continue past the end
+        // of input, nothing is scanned and false is returned.
+        bool scan_token(std::string_view input, size_t pos, bool input_complete, Token& token) const;
+
+        // Same tokens as run, the input is split at top-level expression boundaries into
+        // pieces of at least min_piece_size bytes which are lexed on thread_count threads
+        // (hardware concurrency if 0). The first error in input order is rethrown.
+        TokenStream run_parallel(const std::string& input, size_t thread_count = 0, size_t min_piece_size = 1 << 20) const;
 };
-#endif // LEXER_H
\ No newline at end of file
+#endif // LEXER_H
@@ -0,0 +1,117 @@
+#include <algorithm>
+
+#include "streaming_lexer.h"
+#include "../../utils/program_error.h"
+
+
+StreamingLexer::StreamingLexer(std::istream& input, size_t chunk_size) :
+    input(input), chunk_size(chunk_size), buffer_offset(0), cursor(0), retained(0),
+    input_complete(false), counted_offset(0), counted_lines(0), has_pending(false), at_start(true), finished(false) {
+    assert(chunk_size > 0);
+}
+
+/*
+Drops the bytes nobody refers to anymore and appends the next chunk. While a
+token cut by the window end is pending, the read grows with it (at least as
+many bytes as are pending), so the window doubles and rescanning a token of
+any size costs time linear in its size.
+*/
+bool StreamingLexer::refill() {
+    if (input_complete)
+        return false;
+    count_lines(retained);
+    size_t dropped = retained - buffer_offset;
+    buffer.erase(0, dropped);
+    buffer_offset += dropped;
+    cursor -= dropped;
+
+    size_t read_size = std::max(chunk_size, buffer.size() - cursor);
+    size_t old_size = buffer.size();
+    buffer.resize(old_size + read_size);
+    input.read(&buffer[old_size], read_size);
+    size_t read_count = input.gcount();
+    buffer.resize(old_size + read_count);
+    if (read_count < read_size)
+        input_complete = true;
+    return true;
+}
+
+Token StreamingLexer::scan() {
+    Token token;
+    while (true) {
+        bool scanned = false;
+        try {
+            scanned = (cursor < buffer.size() && lexer.scan_token(buffer, cursor, input_complete, token));
+        }
+        catch (const ProgramError& error) {
+            throw ProgramError(buffer_offset + error.get_position());
+        }
+        if (scanned) {
+            token.position += buffer_offset;
+            cursor += token.length;
+            return token;
+        }
+        if (!refill())
+            break;
+    }
+    // a complete input always scans to its end
+    assert(cursor == buffer.size());
+    return TokenCreator()(TokenKind::eof, buffer_offset + cursor, 0);
+}
+
+/*
+Same rules as Lexer::run: a space token is only emitted between two other
+tokens, so a space needs one token of lookahead.
+*/
+bool StreamingLexer::next(Token& token) {
+    if (finished)
+        return false;
+    if (has_pending) {
+        has_pending = false;
+        token = pending;
+    }
+    else {
+        retained = buffer_offset + cursor;
+        token = scan();
+        if (token.kind == TokenKind::space) {
+            retained = token.position;
+            Token following = scan();
+            if (at_start || following.kind == TokenKind::eof) {
+                token = following;
+            }
+            else {
+                pending = following;
+                has_pending = true;
+            }
+        }
+    }
+    at_start = false;
+    finished = (token.kind == TokenKind::eof);
+    return true;
+}
+
+std::string_view StreamingLexer::get_lexeme(const Token& token) const {
+    return std::string_view(buffer).substr(token.position - buffer_offset, token.length);
+}
+
+std::string_view StreamingLexer::get_text(const Token& token) const {
+    return token_text(token, get_lexeme(token));
+}
+
+std::string StreamingLexer::to_string(const Token& token) const {
+    return token_to_string(token, get_lexeme(token));
+}
+
+void StreamingLexer::count_lines(uint64_t offset) {
+    if (offset <= counted_offset)
+        return;
+    std::string_view counted(buffer.data() + (counted_offset - buffer_offset), offset - counted_offset);
+    counted_lines += byte_scanner.count_newlines(counted, 0);
+    counted_offset = offset;
+}
+
+size_t StreamingLexer::line_of(uint64_t offset) {
+    assert(offset >= counted_offset && offset >= buffer_offset);
+    count_lines(offset);
+    return counted_lines + 1;
+}
@@ -0,0 +1,63 @@
+#ifndef STREAMING_LEXER_H
+#define STREAMING_LEXER_H
+
+#include <istream>
+#include <string>
+#include "lexer.h"
+
+
+/*
+Pull based token source over an input stream. The input is read in chunks of
+chunk_size bytes into a window buffer, consumed bytes are dropped whenever the
+window is refilled, so memory is bounded by the chunk size plus twice the
+largest token. A token cut by the end of the window is rescanned after the
+refill, which reads at least as much as the pending part of the token.
+Produces the same tokens as Lexer::run, positions are offsets in the stream.
+*/
+class StreamingLexer {
+    private:
+        Lexer lexer;
+        ByteScanner byte_scanner;
+        std::istream& input;
+        size_t chunk_size;
+
+        std::string buffer;
+        uint64_t buffer_offset; // stream offset of buffer[0]
+        size_t cursor;          // next unscanned byte in buffer
+        uint64_t retained;      // stream offset of the oldest byte still referenced
+        bool input_complete;
+
+        uint64_t counted_offset; // newlines before counted_offset are in counted_lines
+        size_t counted_lines;
+
+        void count_lines(uint64_t offset);
+
+        Token pending;          // token scanned ahead of a space
+        bool has_pending;
+        bool at_start;
+        bool finished;
+
+        bool refill();
+
+        Token scan();
+    public:
+        static constexpr size_t default_chunk_size = 1 << 16;
+
+        StreamingLexer(std::istream& input, size_t chunk_size = default_chunk_size);
+
+        // Stores the next token, false after the EOF token was returned.
+        bool next(Token& token);
+
+        // Views into the window, valid until the next call of next().
+        std::string_view get_lexeme(const Token& token) const;
+
+        std::string_view get_text(const Token& token) const;
+
+        std::string to_string(const Token& token) const;
+
+        // 1-based line of the byte at offset. Offsets have to be asked in increasing
+        // order and still be in the window (not before the last returned token).
+        size_t line_of(uint64_t offset);
+};
+
+#endif // STREAMING_LEXER_H
@@ -1,75 +1,152 @@
 #include <string>
-#include <typeinfo>
 #include <cassert>
 #include <stdexcept>
-#include <memory>
 #include "tokens.h"
 
-const std::string Token::id_to_token_name[11] = {
+namespace {
+
+const std::string token_kind_names[token_kinds_count] = {
     "KeywordToken", "IdentifierToken", "StringLitToken",
     "DelimiterToken", "ErrorToken", "IntLitToken",
     "FloatLitToken", "BoolLitToken", "NullLitToken",
     "SpaceToken", "EOFToken"
-}; 
+};
+
+}
+
+const std::string& token_kind_name(TokenKind kind) {
+    return token_kind_names[int(kind)];
+}
+
+std::string_view token_text(const Token& token, std::string_view lexeme) {
+    if (token.kind == TokenKind::string_lit)
+        return lexeme.substr(1, lexeme.size() - 2);
+    return lexeme;
+}
+
+std::string token_to_string(const Token& token, std::string_view lexeme) {
+    std::string result = token_kind_name(token.kind) + "(";
+    switch (token.kind) {
+        case TokenKind::int_lit:
+            result += std::to_string(token.int_value);
+            break;
+        case TokenKind::float_lit:
+            result += std::to_string(token.float_value);
+            break;
+        case TokenKind::bool_lit:
+            result += (token.bool_value ? "true" : "false");
+            break;
+        case TokenKind::null_lit:
+        case TokenKind::space:
+        case TokenKind::eof:
+            break;
+        default:
+            result += std::string(token_text(token, lexeme));
+    }
+    return result + ")";
+}
 
-Token::Token(int position) : position(position) { }
+// TokenStream
 
-Token::~Token() = default;
+TokenStream::TokenStream(std::string_view source) : source(source) { }
 
-// std::string Token::to_string() = 0;
+TokenStream::TokenStream(std::string_view source, std::vector<Token> tokens) : source(source), tokens(std::move(tokens)) { }
 
-int Token::get_position() { 
-    return position;
+void TokenStream::push_back(const Token& token) {
+    tokens.push_back(token);
 }
 
+void TokenStream::pop_back() {
+    tokens.pop_back();
+}
+
+size_t TokenStream::size() const {
+    return tokens.size();
+}
+
+const Token& TokenStream::operator[](size_t index) const {
+    return tokens[index];
+}
+
+const Token& TokenStream::back() const {
+    return tokens.back();
+}
+
+std::vector<Token>::const_iterator TokenStream::begin() const {
+    return tokens.begin();
+}
+
+std::vector<Token>::const_iterator TokenStream::end() const {
+    return tokens.end();
+}
+
+std::string_view TokenStream::get_source() const {
+    return source;
+}
+
+std::string_view TokenStream::get_text(const Token& token) const {
+    return token_text(token, source.substr(token.position, token.length));
+}
+
+std::string TokenStream::to_string(const Token& token) const {
+    return token_to_string(token, source.substr(token.position, token.length));
+}
+
+// TokenCreator
+
 TokenCreator::TokenCreator() { }
 
-std::shared_ptr<Token> TokenCreator::operator()(std::string tokenType, int data, int pos) {
-    if (tokenType != "IntLitToken") 
-        throw std::runtime_error("Incorrect token creation for " + tokenType);
-    return std::make_shared<IntLitToken>(data, pos);
+Token TokenCreator::operator()(TokenKind kind, size_t position, size_t length) const {
+    if (kind == TokenKind::int_lit || kind == TokenKind::float_lit || kind == TokenKind::bool_lit || kind == TokenKind::keyword)
+        throw std::runtime_error("Incorrect token creation for " + token_kind_name(kind));
+    Token token;
+    token.kind = kind;
+    token.position = position;
+    token.length = length;
+    token.int_value = 0;
+    return token;
 }
 
-std::shared_ptr<Token> TokenCreator::operator()(std::string tokenType, float data, int pos) {
-    if (tokenType != "FloatLitToken") 
-        throw std::runtime_error("Incorrect token creation for " + tokenType);
-    return std::make_shared<FloatLitToken>(data, pos);                
+Token TokenCreator::operator()(TokenKind kind, int64_t data, size_t position, size_t length) const {
+    if (kind != TokenKind::int_lit)
+        throw std::runtime_error("Incorrect token creation for " + token_kind_name(kind));
+    Token token;
+    token.kind = kind;
+    token.position = position;
+    token.length = length;
+    token.int_value = data;
+    return token;
 }
 
-std::shared_ptr<Token> TokenCreator::operator()(std::string tokenType, std::string data, int pos) {
-    if (tokenType == "StringLitToken") {
-        return std::make_shared<StringLitToken>(data, pos);                
-    }
-    else if (tokenType == "DelimiterToken") {
-        return std::make_shared<DelimiterToken>(data, pos);                
-    }
-    else if (tokenType == "KeywordToken") {
-        return std::make_shared<KeywordToken>(data, pos);                
-    }
-    else if (tokenType == "IdentifierToken") {
-        return std::make_shared<IdentifierToken>(data, pos);
-    }
-    else if (tokenType == "ErrorToken") {
-        return std::make_shared<ErrorToken>(data, pos);                
-    }
-    throw std::runtime_error("Incorrect token creation for " + tokenType);
+Token TokenCreator::operator()(TokenKind kind, double data, size_t position, size_t length) const {
+    if (kind != TokenKind::float_lit)
+        throw std::runtime_error("Incorrect token creation for " + token_kind_name(kind));
+    Token token;
+    token.kind = kind;
+    token.position = position;
+    token.length = length;
+    token.float_value = data;
+    return token;
 }
 
-std::shared_ptr<Token> TokenCreator::operator()(std::string tokenType, bool data, int pos ) {
-    if (tokenType != "BoolLitToken") 
-        throw std::runtime_error("Incorrect token creation for " + tokenType);
-    return std::make_shared<BoolLitToken>(data, pos);
+Token TokenCreator::operator()(TokenKind kind, bool data, size_t position, size_t length) const {
+    if (kind != TokenKind::bool_lit)
+        throw std::runtime_error("Incorrect token creation for " + token_kind_name(kind));
+    Token token;
+    token.kind = kind;
+    token.position = position;
+    token.length = length;
+    token.bool_value = data;
+    return token;
 }
 
-std::shared_ptr<Token> TokenCreator::operator()(std::string tokenType, int pos = 0) {
-    if (tokenType == "NullLitToken") {
-        return std::make_shared<NullLitToken>(pos);
-    }
-    else if (tokenType == "SpaceToken") {
-        return std::make_shared<SpaceToken>(pos);
-    }
-    else if (tokenType == "EOFToken") {
-        return std::make_shared<EOFToken>(pos);
-    }
-    throw std::runtime_error("Incorrect token creation for " + tokenType);
+Token TokenCreator::operator()(TokenKind kind, Keyword data, size_t position, size_t length) const {
+    if (kind != TokenKind::keyword)
+        throw std::runtime_error("Incorrect token creation for " + token_kind_name(kind));
+    Token token;
+    token.kind = kind;
+    token.position = position;
+    token.length = length;
+    token.keyword_value = data;
+    return token;
 }
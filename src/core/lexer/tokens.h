@@ -1,117 +1,97 @@
 #ifndef TOKENS_H
 #define TOKENS_H
 
+#include <cstdint>
 #include <string>
-#include <memory>
+#include <string_view>
+#include <vector>
+#include "keywords.h"
+
+
+enum class TokenKind : uint8_t {
+    keyword,
+    identifier,
+    string_lit,
+    delimiter,
+    error,
+    int_lit,
+    float_lit,
+    bool_lit,
+    null_lit,
+    space,
+    eof
+};
 
+const int token_kinds_count = 11;
+
+const std::string& token_kind_name(TokenKind kind);
+
+// Plain token record, tokens don't own any text: position and length
+// describe the lexeme inside the source buffer of the TokenStream.
+// Keywords, numeric and boolean literals keep their decoded value inline.
+// Positions are 64-bit so that streamed inputs can be addressed by offset.
+struct Token {
+    uint64_t position;
+    uint32_t length;
+    TokenKind kind;
+    union {
+        int64_t int_value;
+        double float_value;
+        bool bool_value;
+        Keyword keyword_value;
+    };
+};
 
+// The text of the token given its lexeme, string literals without the quotes.
+std::string_view token_text(const Token& token, std::string_view lexeme);
 
-class Token {
-private:
-    int position;
+// Human-readable form, e.g. KeywordToken(add) or IntLitToken(3).
+std::string token_to_string(const Token& token, std::string_view lexeme);
 
-public:
-    static const std::string id_to_token_name[11];
-    Token(int position);
-    virtual ~Token();
+// Contiguous token array plus the source buffer it refers to. The buffer
+// has to stay alive as long as the stream is used.
+class TokenStream {
+    private:
+        std::string_view source;
+        std::vector<Token> tokens;
+    public:
+        TokenStream(std::string_view source);
 
-    virtual std::string to_string() = 0;
-    virtual std::string get_type() = 0;
-    int get_position();
-};
+        TokenStream(std::string_view source, std::vector<Token> tokens);
 
-template <typename T, int type_id>
-class GenericToken : public Token {
-private:
-    T data;
+        void push_back(const Token& token);
 
-public:
-    GenericToken(T value, int position);
-    ~GenericToken() override;
+        void pop_back();
 
-    T get_value();
-    std::string get_type() override;
-    std::string to_string() override;
-};
+        size_t size() const;
 
-template<typename T, int type_id>
-GenericToken<T, type_id>::GenericToken(T value, int position) : Token(position), data(value)  {}
-
-template<typename T, int type_id>
-GenericToken<T, type_id>::~GenericToken() {}
-
-template<typename T, int type_id>
-T GenericToken<T, type_id>::get_value() {
-    return data;
-}
-
-template<typename T, int type_id>
-std::string GenericToken<T, type_id>::get_type() {
-    return id_to_token_name[type_id];
-}
-
-template<typename T, int type_id>
-std::string GenericToken<T, type_id>::to_string() {
-    std::string result;
-    if constexpr((std::is_same_v<T, std::string>)) {
-        result = this->get_type() + "(" + data + ")";
-    }
-    else if constexpr((std::is_same_v<T, bool>)) {
-        result = this->get_type() + "(" + (data ?  "true" : "false") + ")";
-    }
-    else {
-        result = this->get_type() + "(" + std::to_string(data) + ")";
-    }
-    return result;
-    // + "(" + std::to_string(get_position()) + ")";
-}   
-
-template <int type_id>
-class EmptyToken : public Token {
-public:
-    EmptyToken(int position);
-    std::string to_string() override;
-    std::string get_type() override;
-};
+        const Token& operator[](size_t index) const;
 
-template<int type_id>
-EmptyToken<type_id>::EmptyToken(int position) : Token(position) { }
+        const Token& back() const;
 
-template<int type_id>
-std::string EmptyToken<type_id>::get_type() {
-    return id_to_token_name[type_id];
-}
+        std::vector<Token>::const_iterator begin() const;
 
-template<int type_id>
-std::string EmptyToken<type_id>::to_string() {
-    std::string result = this->get_type() + "()";
-    return result; 
-    //+ (" + std::to_string(get_position()) +")";
-}
+        std::vector<Token>::const_iterator end() const;
 
+        std::string_view get_source() const;
 
-using KeywordToken = GenericToken<std::string, 0>;
-using IdentifierToken = GenericToken<std::string, 1>;
-using StringLitToken = GenericToken<std::string, 2>;
-using DelimiterToken = GenericToken<std::string, 3>;
-using ErrorToken = GenericToken<std::string, 4>;
-using IntLitToken = GenericToken<int, 5>;
-using FloatLitToken = GenericToken<float, 6>;
-using BoolLitToken = GenericToken<bool, 7>;
-using NullLitToken = EmptyToken<8>;
-using SpaceToken = EmptyToken<9>;
-using EOFToken = EmptyToken<10>;
+        // The lexeme of the token, string literals without the quotes.
+        std::string_view get_text(const Token& token) const;
+
+        // Human-readable form, e.g. KeywordToken(add) or IntLitToken(3).
+        std::string to_string(const Token& token) const;
+};
 
 
 class TokenCreator {
 public:
     TokenCreator();
-    
-    std::shared_ptr<Token> operator()(std::string tokenType, int data, int pos);
-    std::shared_ptr<Token> operator()(std::string tokenType, float data, int pos);
-    std::shared_ptr<Token> operator()(std::string tokenType, std::string data, int pos);
-    std::shared_ptr<Token> operator()(std::string tokenType, bool data, int pos);
-    std::shared_ptr<Token> operator()(std::string tokenType, int pos);
+
+    Token operator()(TokenKind kind, size_t position, size_t length) const;
+    Token operator()(TokenKind kind, int64_t data, size_t position, size_t length) const;
+    Token operator()(TokenKind kind, double data, size_t position, size_t length) const;
+    Token operator()(TokenKind kind, bool data, size_t position, size_t length) const;
+    Token operator()(TokenKind kind, Keyword data, size_t position, size_t length) const;
 };
 
-#endif // TOKENS_H
\ No newline at end of file
+#endif // TOKENS_H
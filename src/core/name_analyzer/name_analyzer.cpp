@@ -0,0 +1,49 @@
+#include "name_analyzer.h"
+
+NameAnalyzer::NameAnalyzer(AstArena& arena, SymbolTable& symbol_table)
+    : arena(arena), symbol_table(symbol_table), error_positions() { }
+
+Expr* NameAnalyzer::make_error(uint64_t position, const std::vector<Expr*>& children) {
+    ErrorExpr* error = arena.create<ErrorExpr>("Name error");
+    error->set_position(position);
+    error->reassign_children(arena, children);
+    error_positions.push_back(position);
+    return error;
+}
+
+Expr* NameAnalyzer::analyze_expr(Expr* expr) {
+    ExprSpan args = expr->get_children();
+    switch (expr->get_kind()) {
+        case ExprKind::set: {
+            if (args.size() != 2 || args[0]->get_kind() != ExprKind::identifier)
+                return make_error(expr->get_position(), {});
+            Expr* value = analyze_expr(args[1]);
+            expr->modify(1, value);
+            IdentifierExpr* var = static_cast<IdentifierExpr*>(args[0]);
+            if (symbol_table.find(var->get_name()) != SymbolTable::no_slot) // set twice
+                return make_error(expr->get_position(), {value});
+            var->set_slot(symbol_table.add(var->get_name()));
+            return expr;
+        }
+        case ExprKind::identifier: {
+            IdentifierExpr* var = static_cast<IdentifierExpr*>(expr);
+            uint32_t slot = symbol_table.find(var->get_name());
+            if (slot == SymbolTable::no_slot) // read before its set
+                return make_error(expr->get_position(), {});
+            var->set_slot(slot);
+            return expr;
+        }
+        default:
+            for (size_t i = 0; i < args.size(); i++)
+                expr->modify(int(i), analyze_expr(args[i]));
+            return expr;
+    }
+}
+
+void NameAnalyzer::analyze(Expr* root) {
+    analyze_expr(root);
+}
+
+const std::vector<uint64_t>& NameAnalyzer::get_error_positions() const {
+    return error_positions;
+}
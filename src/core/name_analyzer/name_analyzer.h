@@ -0,0 +1,42 @@
+#ifndef NAME_ANALYZER_H
+#define NAME_ANALYZER_H
+
+#include <cstdint>
+#include <vector>
+#include "symbol_table.h"
+#include "../ast/ast_arena.h"
+#include "../ast/tree_module.h"
+
+/*
+Resolves the variables of a program before it runs. Expressions are visited
+in evaluation order (operands left to right, then the call): a set gives its
+variable the next slot of the SymbolTable, an identifier gets the slot of its
+variable, so evaluators index an array instead of looking names up.
+
+Errors certain to happen when the execution gets there are found here: a
+variable read before its set, a variable set twice, a malformed set. The
+expression is replaced by an error node at its position, raised where the
+original expression would have raised it: after evaluating the value for a
+second set (the node keeps it as its child), right away otherwise. So the
+output printed before the error doesn't change.
+*/
+class NameAnalyzer {
+    private:
+        AstArena& arena;
+        SymbolTable& symbol_table;
+        std::vector<uint64_t> error_positions;
+
+        Expr* make_error(uint64_t position, const std::vector<Expr*>& children);
+
+        // The expression, or the error node replacing it.
+        Expr* analyze_expr(Expr* expr);
+    public:
+        NameAnalyzer(AstArena& arena, SymbolTable& symbol_table);
+
+        void analyze(Expr* root);
+
+        // Positions of the errors found, in evaluation order.
+        const std::vector<uint64_t>& get_error_positions() const;
+};
+
+#endif // NAME_ANALYZER_H
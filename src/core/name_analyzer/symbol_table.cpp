@@ -0,0 +1,20 @@
+#include "symbol_table.h"
+
+uint32_t SymbolTable::add(std::string_view name) {
+    uint32_t slot = uint32_t(names.size());
+    auto inserted = slots.emplace(std::string(name), slot);
+    names.push_back(inserted.first->first);
+    return slot;
+}
+
+uint32_t SymbolTable::find(std::string_view name) const {
+    auto found = slots.find(name);
+    return found == slots.end() ? no_slot : found->second;
+}
+
+void SymbolTable::truncate(size_t size) {
+    while (names.size() > size) {
+        slots.erase(slots.find(names.back()));
+        names.pop_back();
+    }
+}
@@ -0,0 +1,36 @@
+#ifndef SYMBOL_TABLE_H
+#define SYMBOL_TABLE_H
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/*
+Slots of the variables set so far: dense indices given in the order of the
+sets, which is also the order they run in. Kept across the programs run in
+the same Context (the REPL), so later programs see earlier variables.
+*/
+class SymbolTable {
+    private:
+        std::map<std::string, uint32_t, std::less<>> slots;
+        std::vector<std::string_view> names; // by slot, into the keys of slots
+    public:
+        static constexpr uint32_t no_slot = UINT32_MAX;
+
+        // Slot of a variable that isn't in the table yet.
+        uint32_t add(std::string_view name);
+
+        // no_slot if the variable isn't set.
+        uint32_t find(std::string_view name) const;
+
+        std::string_view get_name(uint32_t slot) const { return names[slot]; }
+
+        size_t size() const { return names.size(); }
+
+        // Forgets the variables from slot size on.
+        void truncate(size_t size);
+};
+
+#endif // SYMBOL_TABLE_H
@@ -0,0 +1,152 @@
+#include <algorithm>
+#include <cassert>
+
+#include "type_checker.h"
+
+namespace {
+
+bool is_numerical(const Expr* expr) {
+    return expr->get_static_type() == Type::int_type || expr->get_static_type() == Type::float_type;
+}
+
+bool is_int(const Expr* expr) {
+    return expr->get_static_type() == Type::int_type;
+}
+
+bool is_string(const Expr* expr) {
+    return expr->get_static_type() == Type::string_type;
+}
+
+}
+
+TypeChecker::TypeChecker(AstArena& arena, const Context& context)
+    : arena(arena), slot_types(context.get_slot_count()), error_positions() {
+    // Slots set by this program are typed when their set is checked, before any read.
+    for (size_t slot = 0; slot < slot_types.size(); slot++)
+        slot_types[slot] = context.get_var(uint32_t(slot)).get_type();
+}
+
+// Same conditions as apply_builtin, on the types instead of the values.
+Type TypeChecker::check_call(Expr* expr, ExprSpan args) {
+    size_t count = args.size();
+    bool all_numerical = std::all_of(args.begin(), args.end(), is_numerical);
+    bool all_int = std::all_of(args.begin(), args.end(), is_int);
+    bool all_strings = std::all_of(args.begin(), args.end(), is_string);
+    auto numerical = [&](bool count_matches, ExprKind int_kind, ExprKind float_kind) {
+        if (!count_matches || !all_numerical)
+            return Type::error_type;
+        expr->specialize(all_int ? int_kind : float_kind);
+        return all_int ? Type::int_type : Type::float_type;
+    };
+    auto comparison = [&](ExprKind specialized_kind) {
+        if (count != 2 || !all_numerical)
+            return Type::error_type;
+        expr->specialize(specialized_kind);
+        return Type::bool_type;
+    };
+    switch (expr->get_kind()) {
+        case ExprKind::add:
+            return numerical(count != 0, ExprKind::add_int, ExprKind::add_float);
+        case ExprKind::subtract:
+            return numerical(count == 2, ExprKind::subtract_int, ExprKind::subtract_float);
+        case ExprKind::multiply:
+            return numerical(count != 0, ExprKind::multiply_int, ExprKind::multiply_float);
+        case ExprKind::divide:
+            return numerical(count == 2, ExprKind::divide_int, ExprKind::divide_float);
+        case ExprKind::min:
+            return numerical(count > 0, ExprKind::min_int, ExprKind::min_float);
+        case ExprKind::max:
+            return numerical(count > 0, ExprKind::max_int, ExprKind::max_float);
+        case ExprKind::abs:
+            return numerical(count == 1, ExprKind::abs_int, ExprKind::abs_float);
+        case ExprKind::gt:
+            return comparison(ExprKind::gt_numeric);
+        case ExprKind::lt:
+            return comparison(ExprKind::lt_numeric);
+        case ExprKind::equal:
+        case ExprKind::not_equal:
+            return count == 2 ? Type::bool_type : Type::error_type;
+        case ExprKind::concat:
+            if (count != 2 || !all_strings)
+                return Type::error_type;
+            expr->specialize(ExprKind::concat_strings);
+            return Type::string_type;
+        case ExprKind::replace:
+            return count == 3 && all_strings ? Type::string_type : Type::error_type;
+        case ExprKind::lowercase:
+        case ExprKind::uppercase:
+            return count == 1 && all_strings ? Type::string_type : Type::error_type;
+        case ExprKind::substring:
+            return count == 3 && is_string(args[0]) && is_int(args[1]) && is_int(args[2]) ? Type::string_type : Type::error_type;
+        case ExprKind::str:
+            return count == 1 ? Type::string_type : Type::error_type;
+        case ExprKind::puts:
+            return count == 1 && all_strings ? Type::null_type : Type::error_type;
+        default:
+            assert(0);
+            return Type::error_type;
+    }
+}
+
+Expr* TypeChecker::check_expr(Expr* expr) {
+    ExprSpan args = expr->get_children();
+    for (size_t i = 0; i < args.size(); i++)
+        expr->modify(int(i), check_expr(args[i]));
+    bool reached = std::none_of(args.begin(), args.end(), [](const Expr* arg) {
+        return arg->get_static_type() == Type::error_type;
+    });
+    Type type = Type::error_type;
+    switch (expr->get_kind()) {
+        case ExprKind::set: { // the variable's identifier isn't read, its type is the value's
+            uint32_t slot = static_cast<IdentifierExpr*>(args[0])->get_slot();
+            slot_types[slot] = args[1]->get_static_type();
+            type = slot_types[slot] == Type::error_type ? Type::error_type : Type::null_type;
+            break;
+        }
+        case ExprKind::int_lit:
+            type = Type::int_type;
+            break;
+        case ExprKind::float_lit:
+            type = Type::float_type;
+            break;
+        case ExprKind::string_lit:
+            type = Type::string_type;
+            break;
+        case ExprKind::bool_lit:
+            type = Type::bool_type;
+            break;
+        case ExprKind::null_lit:
+            type = Type::null_type;
+            break;
+        case ExprKind::identifier:
+            type = slot_types[static_cast<IdentifierExpr*>(expr)->get_slot()];
+            break;
+        case ExprKind::error:
+            break;
+        case ExprKind::program:
+            type = Type::null_type;
+            break;
+        default:
+            if (!reached) // an operand always raises, the call never happens
+                break;
+            type = check_call(expr, args);
+            if (type == Type::error_type) {
+                ErrorExpr* error = arena.create<ErrorExpr>("Type error");
+                error->set_position(expr->get_position());
+                error->reassign_children(arena, std::vector<Expr*>(args.begin(), args.end()));
+                error_positions.push_back(expr->get_position());
+                expr = error;
+            }
+            break;
+    }
+    expr->set_static_type(type);
+    return expr;
+}
+
+void TypeChecker::check(Expr* root) {
+    check_expr(root);
+}
+
+const std::vector<uint64_t>& TypeChecker::get_error_positions() const {
+    return error_positions;
+}
@@ -0,0 +1,47 @@
+#ifndef TYPE_CHECKER_H
+#define TYPE_CHECKER_H
+
+#include <cstdint>
+#include <vector>
+#include "../ast/ast_arena.h"
+#include "../ast/tree_module.h"
+#include "../interpreter/interpreter.h"
+
+/*
+Infers the type of every expression of a program whose names are resolved,
+and annotates the nodes with it. Without branches, and with variables set
+once, every type is known exactly: literals have theirs, a builtin's result
+type follows from its operand types, a variable has the type of the value it
+was set to (in this program, or in an earlier one of the same Context).
+
+A call whose operand types are proven is lowered to the specialized kind of
+its builtin (add_int, concat_strings, ...), which skips the checks. Only the
+checks depending on the values (division by zero, substring bounds) remain.
+
+A call certain to fail (wrong operand count or types) is replaced by an error
+node at its position that keeps the operands, raised after they're evaluated
+like the builtin would. An expression whose operand always raises is never
+called: its type is error_type and it's left alone.
+*/
+class TypeChecker {
+    private:
+        AstArena& arena;
+        std::vector<Type> slot_types;
+        std::vector<uint64_t> error_positions;
+
+        // The result type of the builtin call on its typed operands, error_type
+        // if it certainly fails. Specializes it when possible.
+        Type check_call(Expr* expr, ExprSpan args);
+
+        // The expression, or the error node replacing it.
+        Expr* check_expr(Expr* expr);
+    public:
+        TypeChecker(AstArena& arena, const Context& context);
+
+        void check(Expr* root);
+
+        // Positions of the errors found, in evaluation order.
+        const std::vector<uint64_t>& get_error_positions() const;
+};
+
+#endif // TYPE_CHECKER_H
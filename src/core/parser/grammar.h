@@ -0,0 +1,184 @@
+#ifndef GRAMMAR_H
+#define GRAMMAR_H
+
+#include <array>
+#include <cstdint>
+#include <string_view>
+#include "../lexer/tokens.h"
+
+/*
+The grammar of the language as small integer ids and its LL(1) parse table.
+Everything is constexpr: FIRST sets and the table are computed from the
+productions at compile time, and the grammar is checked to be LL(1).
+
+Program -> Expr Program'
+Program' -> \Space Program | \EOF
+Expr -> \( \Keyword \Space Params | Literal | \Identifier   // \) is handled by Params
+Params -> Expr Params'
+Params' -> \Space Params | \)
+Literal -> \IntLit | \BoolLit | \FloatLit | \StringLit | \NullLit
+*/
+
+// Terminals come first so that they can index the columns of the table.
+enum class GrammarSymbol : uint8_t {
+    keyword,
+    identifier,
+    string_lit,
+    open_paren,
+    close_paren,
+    error,
+    int_lit,
+    float_lit,
+    bool_lit,
+    null_lit,
+    space,
+    eof,
+    program,
+    program_prime,
+    expr,
+    params,
+    params_prime,
+    literal
+};
+
+constexpr int terminals_count = int(GrammarSymbol::program);
+constexpr int nonterminals_count = int(GrammarSymbol::literal) + 1 - terminals_count;
+
+constexpr bool is_terminal(GrammarSymbol symbol) {
+    return int(symbol) < terminals_count;
+}
+
+constexpr int nonterminal_index(GrammarSymbol symbol) {
+    return int(symbol) - terminals_count;
+}
+
+// The terminal a token is matched as, delimiters are split by their text.
+constexpr GrammarSymbol terminal_of(const Token& token, std::string_view text) {
+    switch (token.kind) {
+        case TokenKind::keyword:
+            return GrammarSymbol::keyword;
+        case TokenKind::identifier:
+            return GrammarSymbol::identifier;
+        case TokenKind::string_lit:
+            return GrammarSymbol::string_lit;
+        case TokenKind::delimiter:
+            return text == "(" ? GrammarSymbol::open_paren : GrammarSymbol::close_paren;
+        case TokenKind::int_lit:
+            return GrammarSymbol::int_lit;
+        case TokenKind::float_lit:
+            return GrammarSymbol::float_lit;
+        case TokenKind::bool_lit:
+            return GrammarSymbol::bool_lit;
+        case TokenKind::null_lit:
+            return GrammarSymbol::null_lit;
+        case TokenKind::space:
+            return GrammarSymbol::space;
+        case TokenKind::eof:
+            return GrammarSymbol::eof;
+        default:
+            return GrammarSymbol::error;
+    }
+}
+
+constexpr int max_production_size = 4;
+
+struct Production {
+    GrammarSymbol head;
+    int size;
+    std::array<GrammarSymbol, max_production_size> body;
+};
+
+constexpr Production productions[] = {
+    {GrammarSymbol::program, 2, {GrammarSymbol::expr, GrammarSymbol::program_prime}},
+    {GrammarSymbol::program_prime, 2, {GrammarSymbol::space, GrammarSymbol::program}},
+    {GrammarSymbol::program_prime, 1, {GrammarSymbol::eof}},
+    {GrammarSymbol::expr, 4, {GrammarSymbol::open_paren, GrammarSymbol::keyword, GrammarSymbol::space, GrammarSymbol::params}},
+    {GrammarSymbol::expr, 1, {GrammarSymbol::literal}},
+    {GrammarSymbol::expr, 1, {GrammarSymbol::identifier}},
+    {GrammarSymbol::params, 2, {GrammarSymbol::expr, GrammarSymbol::params_prime}},
+    {GrammarSymbol::params_prime, 2, {GrammarSymbol::space, GrammarSymbol::params}},
+    {GrammarSymbol::params_prime, 1, {GrammarSymbol::close_paren}},
+    {GrammarSymbol::literal, 1, {GrammarSymbol::int_lit}},
+    {GrammarSymbol::literal, 1, {GrammarSymbol::bool_lit}},
+    {GrammarSymbol::literal, 1, {GrammarSymbol::float_lit}},
+    {GrammarSymbol::literal, 1, {GrammarSymbol::string_lit}},
+    {GrammarSymbol::literal, 1, {GrammarSymbol::null_lit}}
+};
+
+constexpr int productions_count = sizeof(productions) / sizeof(productions[0]);
+
+// FIRST sets as bit masks over the terminals. There are no empty productions,
+// so FIRST of a body is FIRST of its first symbol; iterated to a fixed point.
+using TerminalSet = uint32_t;
+
+constexpr std::array<TerminalSet, nonterminals_count> build_first_sets() {
+    std::array<TerminalSet, nonterminals_count> first{};
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (const Production& production : productions) {
+            GrammarSymbol leading = production.body[0];
+            TerminalSet leading_first = is_terminal(leading) ? TerminalSet(1) << int(leading) : first[nonterminal_index(leading)];
+            TerminalSet& head_first = first[nonterminal_index(production.head)];
+            if ((head_first | leading_first) != head_first) {
+                head_first |= leading_first;
+                changed = true;
+            }
+        }
+    }
+    return first;
+}
+
+constexpr std::array<TerminalSet, nonterminals_count> first_sets = build_first_sets();
+
+constexpr TerminalSet first_of_body(const Production& production) {
+    GrammarSymbol leading = production.body[0];
+    return is_terminal(leading) ? TerminalSet(1) << int(leading) : first_sets[nonterminal_index(leading)];
+}
+
+// table[nonterminal][terminal] is the production to expand, -1 is a syntax error
+// and -2 a conflict (the grammar wouldn't be LL(1)).
+using ParseTable = std::array<std::array<int8_t, terminals_count>, nonterminals_count>;
+
+constexpr ParseTable build_parse_table() {
+    ParseTable table{};
+    for (auto& row : table) {
+        for (int8_t& cell : row)
+            cell = -1;
+    }
+    for (int index = 0; index < productions_count; index++) {
+        TerminalSet first = first_of_body(productions[index]);
+        auto& row = table[nonterminal_index(productions[index].head)];
+        for (int terminal = 0; terminal < terminals_count; terminal++) {
+            if (first & (TerminalSet(1) << terminal))
+                row[terminal] = row[terminal] == -1 ? int8_t(index) : int8_t(-2);
+        }
+    }
+    return table;
+}
+
+constexpr ParseTable parse_table = build_parse_table();
+
+constexpr bool grammar_is_ll1() {
+    for (int index = 0; index < productions_count; index++) {
+        if (productions[index].size < 1 || productions[index].size > max_production_size)
+            return false;
+    }
+    for (const auto& row : parse_table) {
+        for (int8_t cell : row) {
+            if (cell == -2)
+                return false;
+        }
+    }
+    return true;
+}
+
+static_assert(grammar_is_ll1(), "the grammar has empty productions or LL(1) conflicts");
+
+// The production for nonterminal on lookahead terminal, nullptr on a syntax error.
+constexpr const Production* find_production(GrammarSymbol nonterminal, GrammarSymbol terminal) {
+    int8_t index = parse_table[nonterminal_index(nonterminal)][int(terminal)];
+    return index < 0 ? nullptr : &productions[index];
+}
+
+#endif // GRAMMAR_H
@@ -1,230 +1,173 @@
 #include <memory>
 #include <cassert>
 #include <vector>
-#include <functional>
-#include <stack>
 #include <algorithm>
-#include <iostream>
-#include <map>
 
 #include "../lexer/tokens.h"
 #include "../ast/tree_module.h"
 #include "parser.h"
+#include "../../utils/program_error.h"
 #include "../../utils/mapper.h"
 
 ParsingStackElement::ParsingStackElement(
-    std::shared_ptr<Symbol> symbol, std::shared_ptr<Expr> expr, std::shared_ptr<Expr> ancestor, int order
+    GrammarSymbol symbol, Expr* expr, Expr* ancestor, int order
 ) : symbol(symbol), expr(expr), expr_ancestor(ancestor), order(order){ }
 
-/*
-
-Program -> Expression Program'
-Program' -> \SpaceToken Program | \EOFToken
-
-Expression -> \DelimiterToken(() Function \SpaceToken Params | Literal //  \DelimiterToken()) is handled by Params!!
-Function -> \KeywordToken(add)|...|\KeywordToken(not_equal)
-Params -> Expression Params'
-Params' -> \SpaceToken Params | \DelimiterToken())
-Literal -> \IntLitToken(...) | \BoolLitToken(...) | \FloatLitToken(...) | \StringLitToken(...) | \IdentifierToken
-
-
-First(Literal) = {\IntLitTOken(...), \BoolLitToken(...), \FloatLitToken(...), \StringLitToken(...), \IdentifierToken}
+// The grammar, its FIRST sets and the parse table are in grammar.h.
 
-First(Expression) = {\DelimiterToken((), \IntLitToken(...), \BoolLitToken(...), 
-                     \FloatLitToken(...), \StringLitToken(...), \IdentifierToken}
+Parser::Parser() = default;
 
-First(Function) = {\KeywordToken(...)}
-
-First(Params) = {\DelimiterToken((), \IntLitToken(...), \BoolLitToken(...), 
-                 \FloatLitToken(...), \StringLitToken(...), \IdentifierToken}
-
-First(Program) = {\DelimiterToken((), \IntLitToken(...), \BoolLitToken(...), {\SpaceToken},
-                  \FloatLitToken(...), \StringLitToken(...), \IdentifierToken}
-
-First(Program') = {\SpaceToken, \EOFToken}
+namespace {
 
+/*
+Recursive descent over the same grammar, one function per nonterminal.
+Program' and Params' are loops, Literal is folded into Expr, and calls are
+created with their operands, so no parse tree nodes are built. Operands are
+collected on one scratch stack shared by all the nesting levels.
+Syntax errors are reported at the same token as the table-driven parser.
 */
-Parser::Parser() {
-    using namespace std;
-    TokenToSymbolMapper tokens_to_symbol_mapper;
-    TokenCreator token_creator;
-    SymbolCreator symbol_creator;
-    
-    // Terminal Symbols:
-    shared_ptr<Symbol> eof_ = tokens_to_symbol_mapper(token_creator("EOFToken", 0));
-    shared_ptr<Symbol> space_ = tokens_to_symbol_mapper(token_creator("SpaceToken", 0));
-    shared_ptr<Symbol> null_lit_ = tokens_to_symbol_mapper(token_creator("NullLitToken", 0));
-    shared_ptr<Symbol> bool_lit_ = tokens_to_symbol_mapper(token_creator("BoolLitToken", false, 0));
-    shared_ptr<Symbol> float_lit_ = tokens_to_symbol_mapper(token_creator("FloatLitToken", float(0.0), 0));
-    shared_ptr<Symbol> int_lit_ = tokens_to_symbol_mapper(token_creator("IntLitToken", int(0), 0));
-    shared_ptr<Symbol> error_ = tokens_to_symbol_mapper(token_creator("ErrorToken", std::string(""), 0));
-    
-    shared_ptr<Symbol> delimiter_ob_ = symbol_creator(token_creator("DelimiterToken", std::string("("), 0)->get_type() + "(()");
-    shared_ptr<Symbol> delimiter_cb_ = symbol_creator(token_creator("DelimiterToken", std::string(")"), 0)->get_type() + "())");
-    
-    shared_ptr<Symbol> string_lit_ = tokens_to_symbol_mapper(token_creator("StringLitToken", std::string(""), 0));
-    shared_ptr<Symbol> identifier_ = tokens_to_symbol_mapper(token_creator("IdentifierToken", std::string("a"), 0));
-    shared_ptr<Symbol> keyword_ = tokens_to_symbol_mapper(token_creator("KeywordToken", std::string(""), 0));
-    
-    // it can be a bad design decision, but...
-    // Problem : The production rule X are stored inside the symbolA,
-    //           sometimes production rule X can contain the symbolA
-    //           itself, but to create symbolA and add it to X we need
-    //           to create production rule X, ...
-    // So there are 2 ways to resolve the problem
-    // 1. Move the production rules from symbols, for example create some
-    //    production rule table, but it's not too convenient for me
-    // 2. Using the shared_ptr properties just update the rules after symbol
-    //    creation. I'll use this one.
-
-    shared_ptr<ProductionRules> literal_rules = make_shared<ProductionRules>(
-        vector<pair<shared_ptr<Symbol>, vector<shared_ptr<Symbol>>>>()
-    );
-    shared_ptr<Symbol> literal = symbol_creator("Literal", literal_rules);
-
-    shared_ptr<ProductionRules> params_prime_rules = make_shared<ProductionRules>(
-        vector<pair<shared_ptr<Symbol>, vector<shared_ptr<Symbol>>>>()
-    );
-    shared_ptr<Symbol> params_prime = symbol_creator("Params\'", params_prime_rules);
-
-    shared_ptr<ProductionRules> params_rules = make_shared<ProductionRules>(
-        vector<pair<shared_ptr<Symbol>, vector<shared_ptr<Symbol>>>>()
-    );
-    shared_ptr<Symbol> params = symbol_creator("Params", params_rules);
-
-    shared_ptr<ProductionRules> program_prime_rules = make_shared<ProductionRules>(
-        vector<pair<shared_ptr<Symbol>, vector<shared_ptr<Symbol>>>>()
-    );
-    shared_ptr<Symbol> program_prime = symbol_creator("Program\'", program_prime_rules);
-
-    shared_ptr<ProductionRules> expr_rules = make_shared<ProductionRules>(
-        vector<pair<shared_ptr<Symbol>, vector<shared_ptr<Symbol>>>>()
-    );
-    shared_ptr<Symbol> expression = symbol_creator("Expr", expr_rules);
-    
-    shared_ptr<ProductionRules> program_rules = make_shared<ProductionRules>(
-        vector<pair<shared_ptr<Symbol>, vector<shared_ptr<Symbol>>>>()
-    );
-    shared_ptr<Symbol> program = symbol_creator("Program", program_rules);
-
-
-    // Rules
-    literal_rules->add_rules({
-            make_pair(null_lit_, vector<shared_ptr<Symbol>>{null_lit_}), 
-            make_pair(bool_lit_, vector<shared_ptr<Symbol>>{bool_lit_}),
-            make_pair(float_lit_, vector<shared_ptr<Symbol>>{float_lit_}), 
-            make_pair(int_lit_, vector<shared_ptr<Symbol>>{int_lit_}),
-            make_pair(string_lit_, vector<shared_ptr<Symbol>>{string_lit_})
+class DescentParser {
+    private:
+        const TokenStream& input;
+        AstArena& arena;
+        size_t input_pos = 0;
+        std::vector<Expr*> operands;
+
+        GrammarSymbol lookahead() const {
+            if (input_pos == input.size()) // a stream without EOF
+                return GrammarSymbol::error;
+            return terminal_of(input[input_pos], input.get_text(input[input_pos]));
         }
-    );
 
-    expr_rules->add_rules({
-            make_pair(
-                delimiter_ob_, 
-                vector<shared_ptr<Symbol>>{
-                    delimiter_ob_, keyword_, space_, params
-                }
-            ), 
-            make_pair(null_lit_, vector<shared_ptr<Symbol>>{literal}), 
-            make_pair(bool_lit_, vector<shared_ptr<Symbol>>{literal}),
-            make_pair(float_lit_, vector<shared_ptr<Symbol>>{literal}), 
-            make_pair(int_lit_, vector<shared_ptr<Symbol>>{literal}),
-            make_pair(string_lit_, vector<shared_ptr<Symbol>>{literal}),
-            make_pair(identifier_, vector<shared_ptr<Symbol>>{identifier_}) // maybe provide better interface in prod_rules? TODO
-        }
-    );
-
-    program_rules->add_rules({
-            make_pair(delimiter_ob_, vector<shared_ptr<Symbol>>{expression, program_prime}), 
-            make_pair(null_lit_, vector<shared_ptr<Symbol>>{expression, program_prime}), 
-            make_pair(bool_lit_, vector<shared_ptr<Symbol>>{expression, program_prime}),
-            make_pair(float_lit_, vector<shared_ptr<Symbol>>{expression, program_prime}), 
-            make_pair(int_lit_, vector<shared_ptr<Symbol>>{expression, program_prime}),
-            make_pair(string_lit_, vector<shared_ptr<Symbol>>{expression, program_prime}),
-            make_pair(identifier_, vector<shared_ptr<Symbol>>{expression, program_prime})
+        [[noreturn]] void fail() const {
+            throw ProgramError(input[std::min(input_pos, input.size() - 1)].position);
         }
-    );
 
-    program_prime_rules->add_rules({
-            make_pair(space_, vector<shared_ptr<Symbol>>{space_, program}),
-            make_pair(eof_, vector<shared_ptr<Symbol>>{eof_})
+        void expect(GrammarSymbol terminal) {
+            if (lookahead() != terminal)
+                fail();
+            input_pos++;
         }
-    );    
-
-    params_rules->add_rules({
-            make_pair(delimiter_ob_, vector<shared_ptr<Symbol>>{expression, params_prime}), 
-            make_pair(null_lit_, vector<shared_ptr<Symbol>>{expression, params_prime}), 
-            make_pair(bool_lit_, vector<shared_ptr<Symbol>>{expression, params_prime}),
-            make_pair(float_lit_, vector<shared_ptr<Symbol>>{expression, params_prime}), 
-            make_pair(int_lit_, vector<shared_ptr<Symbol>>{expression, params_prime}),
-            make_pair(string_lit_, vector<shared_ptr<Symbol>>{expression, params_prime}),
-            make_pair(identifier_, vector<shared_ptr<Symbol>>{expression, params_prime})
+
+        Expr* take_token() {
+            const Token& token = input[input_pos++];
+            return TokenToExprMapper(arena)(token, input.get_text(token));
         }
-    );
 
-    params_prime_rules->add_rules({
-            make_pair(space_, vector<shared_ptr<Symbol>>{space_, params}),
-            make_pair(delimiter_cb_, vector<shared_ptr<Symbol>>{delimiter_cb_})
+        // Expr -> ( Keyword Space Params | Literal | Identifier
+        Expr* parse_expr() {
+            switch (lookahead()) {
+                case GrammarSymbol::open_paren: {
+                    input_pos++;
+                    if (lookahead() != GrammarSymbol::keyword)
+                        fail();
+                    Expr* call = take_token();
+                    expect(GrammarSymbol::space);
+                    parse_params(call);
+                    return call;
+                }
+                case GrammarSymbol::identifier:
+                case GrammarSymbol::int_lit:
+                case GrammarSymbol::bool_lit:
+                case GrammarSymbol::float_lit:
+                case GrammarSymbol::string_lit:
+                case GrammarSymbol::null_lit:
+                    return take_token();
+                default:
+                    fail();
+            }
         }
-    );   
-    this->start_symbol = program;
-}
 
+        // Params -> Expr Params', Params' -> Space Params | )
+        void parse_params(Expr* call) {
+            size_t first_operand = operands.size();
+            while (true) {
+                operands.push_back(parse_expr());
+                GrammarSymbol next = lookahead();
+                if (next == GrammarSymbol::close_paren)
+                    break;
+                if (next != GrammarSymbol::space)
+                    fail();
+                input_pos++;
+            }
+            input_pos++;
+            call->reassign_children(arena, operands.data() + first_operand, operands.size() - first_operand);
+            operands.resize(first_operand);
+        }
 
+    public:
+        DescentParser(const TokenStream& input, AstArena& arena) : input(input), arena(arena) { }
+
+        // Program -> Expr Program', Program' -> Space Program | EOF
+        Expr* parse_program() {
+            while (true) {
+                operands.push_back(parse_expr());
+                GrammarSymbol next = lookahead();
+                if (next == GrammarSymbol::eof)
+                    break;
+                if (next != GrammarSymbol::space)
+                    fail();
+                input_pos++;
+            }
+            if (input_pos + 1 != input.size()) // nothing may follow EOF
+                fail();
+            Expr* program = ExprCreator(arena)("ParseTempExpr(Program)");
+            program->reassign_children(arena, operands);
+            return program;
+        }
+};
 
-std::shared_ptr<Expr> build_concrete_syntax_tree(std::vector<std::shared_ptr<Token>>& input, std::shared_ptr<Symbol> start_symbol) {
+// The table-driven parser, only reachable through Parser::parse_two_phase.
+Expr* build_concrete_syntax_tree(const TokenStream& input, AstArena& arena) {
     using namespace std;
     // Init concrete syntax tree
-    shared_ptr<Expr> parse_tree_root = SymbolToExprMapper()(start_symbol);
+    Expr* parse_tree_root = SymbolToExprMapper(arena)(GrammarSymbol::program);
 
 
     // Init parsing stack
-    stack<ParsingStackElement> parsing_stack;
-    parsing_stack.push(ParsingStackElement{start_symbol, parse_tree_root, nullptr, -1});
+    vector<ParsingStackElement> parsing_stack;
+    parsing_stack.push_back(ParsingStackElement{GrammarSymbol::program, parse_tree_root, nullptr, -1});
 
     // Init current symbol
     int input_pos = 0;
-    shared_ptr<Symbol> cur_input_symb = TokenToSymbolMapper()(input[0]);
-
-
+    GrammarSymbol cur_input_symb = TokenToSymbolMapper()(input[0], input.get_text(input[0]));
 
     while (parsing_stack.size()) {
+        ParsingStackElement top = std::move(parsing_stack.back());
+        parsing_stack.pop_back();
 
-        // cerr << parsing_stack.top().symbol->get_symbol_str() << " " << cur_input_symb->get_symbol_str() << " " << input_pos << "\n";
-
-        if (*(parsing_stack.top().symbol) == *cur_input_symb) {
+        if (is_terminal(top.symbol)) {
+            if (top.symbol != cur_input_symb)
+                throw ProgramError(input[input_pos].position);
             // Inject real data into dummy token
-            parsing_stack.top().expr_ancestor->modify(parsing_stack.top().order, TokenToExprMapper()(input[input_pos]));
-            parsing_stack.pop();
+            top.expr_ancestor->modify(top.order, TokenToExprMapper(arena)(input[input_pos], input.get_text(input[input_pos])));
             input_pos += 1;
             if (input_pos == input.size()) {
-                assert(parsing_stack.size() == 0);
+                if (parsing_stack.size())
+                    throw ProgramError(input.back().position);
                 break;
             }
-            cur_input_symb = TokenToSymbolMapper()(input[input_pos]);
-        }  
+            cur_input_symb = TokenToSymbolMapper()(input[input_pos], input.get_text(input[input_pos]));
+        }
         else {
-            vector<shared_ptr<Symbol>> decomposed_form = parsing_stack.top().symbol->decompose(cur_input_symb);
-            shared_ptr<Expr> cur_expr = parsing_stack.top().expr;
-            reverse(decomposed_form.begin(), decomposed_form.end());
-            parsing_stack.pop();
-
-            vector<shared_ptr<Expr>> cur_expr_children;
-
-            for(int ind = 0; ind < decomposed_form.size(); ind++) {
-                parsing_stack.push(
-                    ParsingStackElement{decomposed_form[ind], SymbolToExprMapper()(decomposed_form[ind]), cur_expr, (int)(decomposed_form.size()) - ind - 1}
+            const Production* production = find_production(top.symbol, cur_input_symb);
+            if (production == nullptr) // no rule for the current token
+                throw ProgramError(input[input_pos].position);
+
+            Expr* cur_expr_children[max_production_size];
+            for (int ind = production->size - 1; ind >= 0; ind--) {
+                cur_expr_children[ind] = SymbolToExprMapper(arena)(production->body[ind]);
+                parsing_stack.push_back(
+                    ParsingStackElement{production->body[ind], cur_expr_children[ind], top.expr, ind}
                 );
-                cur_expr_children.push_back(parsing_stack.top().expr);
             }
-            reverse(cur_expr_children.begin(), cur_expr_children.end());
-            cur_expr->reassign_children(cur_expr_children);
+            top.expr->reassign_children(arena, cur_expr_children, production->size);
         }
     }
     return parse_tree_root;
 }
 
-std::shared_ptr<Expr> build_ast(std::shared_ptr<Expr> expr) {
+Expr* build_ast(Expr* expr, AstArena& arena) {
     using namespace std;
 
     shared_ptr<ExprTypeVisitor> type_visitor = make_shared<ExprTypeVisitor>();
@@ -232,15 +175,15 @@ std::shared_ptr<Expr> build_ast(std::shared_ptr<Expr> expr) {
         return expr;
 
 
-    vector<shared_ptr<Expr>> children_exprs = expr->get_children();
-    vector<shared_ptr<Expr>> new_children_exprs;
+    ExprSpan children_exprs = expr->get_children();
+    vector<Expr*> new_children_exprs;
 
     shared_ptr<ParserTempTypeVisitor> visitor = make_shared<ParserTempTypeVisitor>();
 
     std::string expr_type = visitor->get_parser_type(expr, visitor);
 
     for(auto child_expr : children_exprs) {
-        shared_ptr<Expr> child_ast = build_ast(child_expr);
+        Expr* child_ast = build_ast(child_expr, arena);
         if (child_ast != nullptr) {
             new_children_exprs.push_back(child_ast);
         }
@@ -249,13 +192,13 @@ std::shared_ptr<Expr> build_ast(std::shared_ptr<Expr> expr) {
     if (expr_type == "(Program)" || expr_type == "(Params)") {
         assert(children_exprs.size() == 2);
         if (new_children_exprs.size() == 2) {
-            vector<shared_ptr<Expr>> children = new_children_exprs[1]->get_children();
+            ExprSpan children = new_children_exprs[1]->get_children();
             new_children_exprs.pop_back();
             for (auto u : children) {
                 new_children_exprs.push_back(u);
             }
         }
-        expr->reassign_children(new_children_exprs);
+        expr->reassign_children(arena, new_children_exprs);
         return expr;
     }
     else if (expr_type == "(Program')" || expr_type == "(Params')" || expr_type == "(Literal)") {
@@ -269,36 +212,33 @@ std::shared_ptr<Expr> build_ast(std::shared_ptr<Expr> expr) {
             return new_children_exprs[0];
         }
         assert(new_children_exprs.size() == 2);
-        new_children_exprs[0]->reassign_children(new_children_exprs[1]->get_children());
+        ExprSpan operands = new_children_exprs[1]->get_children();
+        new_children_exprs[0]->reassign_children(arena, operands.begin(), operands.size());
         return new_children_exprs[0];
     }
     else if (expr_type == "()") {
         if (new_children_exprs.size() == 0)
             return nullptr;
-        expr->reassign_children(new_children_exprs);
+        expr->reassign_children(arena, new_children_exprs);
         return expr;
     }
 
     return expr;
 }
 
-int number_nodes(std::shared_ptr<Expr> v) {
-    if (v == nullptr) return 0;
-    int answ = 1;
-    for(auto u : v->get_children()) {
-        answ += number_nodes(u);
-    }
-    return answ;
 }
 
-std::shared_ptr<Expr> Parser::parse(std::vector<std::shared_ptr<Token>> input)  {
-    using namespace std;
-    
-    
+Expr* Parser::parse(const TokenStream& input, AstArena& arena)  {
+    if (input.size() == 0)
+        return nullptr;
+    return DescentParser(input, arena).parse_program();
+}
+
+Expr* Parser::parse_two_phase(const TokenStream& input, AstArena& arena)  {
     if (input.size() == 0)
         return nullptr;
-    shared_ptr<Expr> parse_tree_root = build_concrete_syntax_tree(input, this->start_symbol);
-    shared_ptr<Expr> ast_root = build_ast(parse_tree_root);
+    Expr* parse_tree_root = build_concrete_syntax_tree(input, arena);
+    Expr* ast_root = build_ast(parse_tree_root, arena);
     return ast_root;
 }
 
@@ -7,25 +7,30 @@
 #include <functional>
 #include <stack>
 
-#include "symbol.h"
+#include "grammar.h"
 #include "../lexer/tokens.h"
 #include "../ast/tree_module.h"
 
 class Parser {
     private:
-        std::shared_ptr<Symbol> start_symbol;
     public:
         Parser();
 
-        std::shared_ptr<Expr> parse(std::vector<std::shared_ptr<Token>> input);
+        // Builds the AST in one recursive descent pass.
+        // Nodes are allocated in the arena, which owns the tree.
+        Expr* parse(const TokenStream& input, AstArena& arena);
+
+        // The table-driven parser: a concrete parse tree, then build_ast.
+        // Same result as parse, kept as a reference for tests and benchmarks.
+        Expr* parse_two_phase(const TokenStream& input, AstArena& arena);
 };
 
 struct ParsingStackElement {
-    std::shared_ptr<Symbol> symbol;
-    std::shared_ptr<Expr> expr;
-    std::shared_ptr<Expr> expr_ancestor;
+    GrammarSymbol symbol;
+    Expr* expr;
+    Expr* expr_ancestor;
     int order;
-    ParsingStackElement(std::shared_ptr<Symbol> symbol, std::shared_ptr<Expr> expr, std::shared_ptr<Expr> expr_ancestor, int order);
+    ParsingStackElement(GrammarSymbol symbol, Expr* expr, Expr* expr_ancestor, int order);
 };
 
 
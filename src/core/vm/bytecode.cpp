@@ -0,0 +1,115 @@
+#include <algorithm>
+#include <array>
+#include <cassert>
+
+#include "bytecode.h"
+
+const std::string& op_code_name(OpCode op_code) {
+    static const std::array<std::string, 8> names = {
+        "push_constant", "load_var", "store_var", "call_builtin", "puts", "pop", "fail", "halt"
+    };
+    return names[int(op_code)];
+}
+
+void Bytecode::emit(OpCode op_code, uint32_t operand, uint64_t position, ExprKind builtin) {
+    code.push_back(Instruction{op_code, builtin, operand});
+    positions.push_back(position);
+}
+
+uint32_t Bytecode::add_constant(ReturnValue constant) {
+    constants.push_back(std::move(constant));
+    return uint32_t(constants.size() - 1);
+}
+
+void Bytecode::set_max_stack_depth(size_t depth) {
+    max_stack_depth = depth;
+}
+
+std::string Bytecode::to_string() const {
+    std::string result;
+    for (const Instruction& instruction : code) {
+        result += op_code_name(instruction.op_code) + " " + std::to_string(instruction.operand) + "\n";
+    }
+    return result;
+}
+
+void BytecodeCompiler::push(size_t count) {
+    depth += count;
+    bytecode.set_max_stack_depth(std::max(bytecode.get_max_stack_depth(), depth));
+}
+
+void BytecodeCompiler::pop(size_t count) {
+    depth -= count;
+}
+
+void BytecodeCompiler::compile_expr(Expr* expr) {
+    ExprSpan args = expr->get_children();
+    uint64_t position = expr->get_position();
+    switch (expr->get_kind()) {
+        case ExprKind::set: // well formed, or the NameAnalyzer replaced it
+            compile_expr(args[1]);
+            bytecode.emit(OpCode::store_var, static_cast<IdentifierExpr*>(args[0])->get_slot(), position);
+            return;
+        case ExprKind::int_lit:
+            bytecode.emit(OpCode::push_constant, bytecode.add_constant(
+                ReturnValue((int)(static_cast<IntLiteral*>(expr)->get_value()))), position);
+            push(1);
+            return;
+        case ExprKind::float_lit:
+            bytecode.emit(OpCode::push_constant, bytecode.add_constant(
+                ReturnValue((float)(static_cast<FloatLiteral*>(expr)->get_value()))), position);
+            push(1);
+            return;
+        case ExprKind::string_lit:
+            bytecode.emit(OpCode::push_constant, bytecode.add_constant(
+                ReturnValue(std::string(static_cast<StringLiteral*>(expr)->get_value()))), position);
+            push(1);
+            return;
+        case ExprKind::bool_lit:
+            bytecode.emit(OpCode::push_constant, bytecode.add_constant(
+                ReturnValue((bool)(static_cast<BoolLiteral*>(expr)->get_value()))), position);
+            push(1);
+            return;
+        case ExprKind::null_lit:
+            bytecode.emit(OpCode::push_constant, bytecode.add_constant(ReturnValue()), position);
+            push(1);
+            return;
+        case ExprKind::identifier:
+            bytecode.emit(OpCode::load_var, static_cast<IdentifierExpr*>(expr)->get_slot(), position);
+            push(1);
+            return;
+        case ExprKind::error:
+            for (Expr* arg : args)
+                compile_expr(arg);
+            bytecode.emit(OpCode::fail, 0, position);
+            pop(args.size());
+            push(1); // never reached, keeps the stack balanced for the caller
+            return;
+        case ExprKind::program:
+            assert(0); // only the root, see compile
+            return;
+        default:
+            for (Expr* arg : args)
+                compile_expr(arg);
+            if (expr->get_kind() == ExprKind::puts && args.size() == 1)
+                bytecode.emit(OpCode::puts, 1, position);
+            else
+                bytecode.emit(OpCode::call_builtin, uint32_t(args.size()), position, expr->get_kind());
+            pop(args.size());
+            push(1);
+            return;
+    }
+}
+
+Bytecode BytecodeCompiler::compile(Expr* root) {
+    bytecode = Bytecode();
+    depth = 0;
+    assert(root->get_kind() == ExprKind::program);
+    for (Expr* expr : root->get_children()) {
+        compile_expr(expr);
+        bytecode.emit(OpCode::pop, 0, expr->get_position());
+        pop(1);
+    }
+    bytecode.emit(OpCode::halt, 0, root->get_position());
+    return std::move(bytecode);
+}
@@ -0,0 +1,76 @@
+#ifndef BYTECODE_H
+#define BYTECODE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "../ast/tree_module.h"
+#include "../interpreter/interpreter.h"
+
+enum class OpCode : uint8_t {
+    push_constant, // push constants[operand]
+    load_var, // push the value of the variable in slot operand
+    store_var, // pop a value into the variable in slot operand, push null (the value of set)
+    call_builtin, // pop operand values, push builtin(values)
+    puts, // pop a string and print it, push null
+    pop, // drop the value of a top-level expression
+    fail, // raise the program error of an error node, its operand values are on the stack
+    halt
+};
+
+const std::string& op_code_name(OpCode op_code);
+
+// 8 bytes, the position of each instruction is kept aside since it's only
+// needed to report errors.
+struct Instruction {
+    OpCode op_code;
+    ExprKind builtin; // call_builtin only
+    uint32_t operand;
+};
+
+class Bytecode {
+    private:
+        std::vector<Instruction> code;
+        std::vector<uint64_t> positions;
+        std::vector<ReturnValue> constants;
+        size_t max_stack_depth = 0;
+    public:
+        const std::vector<Instruction>& get_code() const { return code; }
+
+        uint64_t get_position(size_t instruction) const { return positions[instruction]; }
+
+        const ReturnValue& get_constant(uint32_t index) const { return constants[index]; }
+
+        size_t get_max_stack_depth() const { return max_stack_depth; }
+
+        void emit(OpCode op_code, uint32_t operand, uint64_t position, ExprKind builtin = ExprKind::error);
+
+        uint32_t add_constant(ReturnValue constant);
+
+        void set_max_stack_depth(size_t depth);
+
+        // One instruction per line, for debugging.
+        std::string to_string() const;
+};
+
+/*
+Compiles the AST to stack code: operands are pushed left to right, then the
+call pops them, which evaluates in the same order as the tree walker. An
+error node becomes a fail instruction after its operands, at the same point
+of the execution. Variables are the slots given by the NameAnalyzer.
+*/
+class BytecodeCompiler {
+    private:
+        Bytecode bytecode;
+        size_t depth = 0;
+
+        void push(size_t count);
+
+        void pop(size_t count);
+
+        void compile_expr(Expr* expr);
+    public:
+        Bytecode compile(Expr* root);
+};
+
+#endif // BYTECODE_H
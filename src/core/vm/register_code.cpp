@@ -0,0 +1,154 @@
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <functional>
+#include <queue>
+
+#include "register_code.h"
+
+const std::string& reg_op_code_name(RegOpCode op_code) {
+    static const std::array<std::string, 5> names = {"call", "store_var", "puts", "fail", "halt"};
+    return names[int(op_code)];
+}
+
+std::string RegisterCode::to_string() const {
+    std::string result;
+    for (const RegInstruction& instruction : code) {
+        result += reg_op_code_name(instruction.op_code);
+        if (instruction.op_code == RegOpCode::call)
+            result += " r" + std::to_string(instruction.dest);
+        for (uint32_t i = 0; i < instruction.operand_count; i++) {
+            const Operand& operand = operands[instruction.first_operand + i];
+            if (operand.kind == OperandKind::reg)
+                result += " r" + std::to_string(operand.index);
+            else if (operand.kind == OperandKind::constant)
+                result += " c" + std::to_string(operand.index);
+            else
+                result += " v" + std::to_string(operand.index);
+        }
+        result += "\n";
+    }
+    return result;
+}
+
+uint32_t RegisterCompiler::emit(RegOpCode op_code, uint64_t position, const std::vector<Operand>& operands,
+                                ExprKind builtin) {
+    uint32_t instruction = uint32_t(register_code.code.size());
+    register_code.code.push_back(RegInstruction{
+        op_code, builtin, 0, uint32_t(register_code.operands.size()), uint32_t(operands.size())
+    });
+    register_code.positions.push_back(position);
+    for (const Operand& operand : operands) {
+        if (operand.kind == OperandKind::reg)
+            live_ranges[operand.index].end = instruction;
+    }
+    register_code.operands.insert(register_code.operands.end(), operands.begin(), operands.end());
+    register_code.max_operand_count = std::max(register_code.max_operand_count, operands.size());
+    return instruction;
+}
+
+uint32_t RegisterCompiler::add_constant(ReturnValue constant) {
+    register_code.constants.push_back(std::move(constant));
+    return uint32_t(register_code.constants.size() - 1);
+}
+
+uint32_t RegisterCompiler::new_register(uint32_t instruction) {
+    live_ranges.push_back(LiveRange{instruction, instruction}); // an unused result dies where it's defined
+    register_code.code[instruction].dest = uint32_t(live_ranges.size() - 1);
+    return uint32_t(live_ranges.size() - 1);
+}
+
+Operand RegisterCompiler::compile_operand(Expr* expr) {
+    ExprSpan args = expr->get_children();
+    uint64_t position = expr->get_position();
+    switch (expr->get_kind()) {
+        case ExprKind::set: { // well formed, or the NameAnalyzer replaced it
+            Operand target{OperandKind::variable, static_cast<IdentifierExpr*>(args[0])->get_slot()};
+            Operand value = compile_operand(args[1]);
+            emit(RegOpCode::store_var, position, {target, value});
+            return Operand{OperandKind::constant, null_constant};
+        }
+        case ExprKind::int_lit:
+            return Operand{OperandKind::constant, add_constant(
+                ReturnValue((int)(static_cast<IntLiteral*>(expr)->get_value())))};
+        case ExprKind::float_lit:
+            return Operand{OperandKind::constant, add_constant(
+                ReturnValue((float)(static_cast<FloatLiteral*>(expr)->get_value())))};
+        case ExprKind::string_lit:
+            return Operand{OperandKind::constant, add_constant(
+                ReturnValue(std::string(static_cast<StringLiteral*>(expr)->get_value())))};
+        case ExprKind::bool_lit:
+            return Operand{OperandKind::constant, add_constant(
+                ReturnValue((bool)(static_cast<BoolLiteral*>(expr)->get_value())))};
+        case ExprKind::null_lit:
+            return Operand{OperandKind::constant, null_constant};
+        case ExprKind::identifier:
+            return Operand{OperandKind::variable, static_cast<IdentifierExpr*>(expr)->get_slot()};
+        case ExprKind::program:
+            assert(0); // only the root, see compile
+            return Operand{OperandKind::constant, null_constant};
+        default: {
+            std::vector<Operand> operands;
+            for (Expr* arg : args)
+                operands.push_back(compile_operand(arg));
+            if (expr->get_kind() == ExprKind::error) {
+                emit(RegOpCode::fail, position, operands);
+                return Operand{OperandKind::constant, null_constant};
+            }
+            if (expr->get_kind() == ExprKind::puts && args.size() == 1) {
+                emit(RegOpCode::puts, position, operands);
+                return Operand{OperandKind::constant, null_constant};
+            }
+            uint32_t instruction = emit(RegOpCode::call, position, operands, expr->get_kind());
+            return Operand{OperandKind::reg, new_register(instruction)};
+        }
+    }
+}
+
+/*
+Live ranges are created in the order of their start, so one pass assigns them:
+ranges ending at or before the current start give their register back (an
+instruction reads its operands before writing its destination, so it can
+reuse the register of one of them), then the lowest free register is taken.
+*/
+void RegisterCompiler::assign_registers() {
+    using Active = std::pair<uint32_t, uint32_t>; // end, physical register
+    std::priority_queue<Active, std::vector<Active>, std::greater<Active>> active;
+    std::priority_queue<uint32_t, std::vector<uint32_t>, std::greater<uint32_t>> free_registers;
+    std::vector<uint32_t> physical(live_ranges.size());
+    uint32_t register_count = 0;
+    for (size_t virtual_register = 0; virtual_register < live_ranges.size(); virtual_register++) {
+        const LiveRange& range = live_ranges[virtual_register];
+        while (!active.empty() && active.top().first <= range.start) {
+            free_registers.push(active.top().second);
+            active.pop();
+        }
+        if (free_registers.empty()) {
+            free_registers.push(register_count++);
+        }
+        physical[virtual_register] = free_registers.top();
+        free_registers.pop();
+        active.push(Active{range.end, physical[virtual_register]});
+    }
+    for (RegInstruction& instruction : register_code.code) {
+        if (instruction.op_code == RegOpCode::call)
+            instruction.dest = physical[instruction.dest];
+    }
+    for (Operand& operand : register_code.operands) {
+        if (operand.kind == OperandKind::reg)
+            operand.index = physical[operand.index];
+    }
+    register_code.register_count = register_count;
+}
+
+RegisterCode RegisterCompiler::compile(Expr* root) {
+    register_code = RegisterCode();
+    live_ranges.clear();
+    null_constant = add_constant(ReturnValue());
+    assert(root->get_kind() == ExprKind::program);
+    for (Expr* expr : root->get_children())
+        compile_operand(expr);
+    emit(RegOpCode::halt, root->get_position(), {});
+    assign_registers();
+    return std::move(register_code);
+}
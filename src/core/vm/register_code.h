@@ -0,0 +1,105 @@
+#ifndef REGISTER_CODE_H
+#define REGISTER_CODE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "../ast/tree_module.h"
+#include "../interpreter/interpreter.h"
+
+enum class OperandKind : uint8_t {
+    reg,
+    constant,
+    variable // read in place from the context when the instruction runs
+};
+
+struct Operand {
+    OperandKind kind;
+    uint32_t index; // register, constant or variable slot
+};
+
+enum class RegOpCode : uint8_t {
+    call, // dest = builtin(operands)
+    store_var, // operands[0] (a variable) = operands[1]
+    puts, // print operands[0], a string
+    fail, // raise the program error of an error node, once its operands are evaluated
+    halt
+};
+
+const std::string& reg_op_code_name(RegOpCode op_code);
+
+/*
+Three-address instruction: a destination register and a list of operands kept
+in a side array, so calls of any arity have the same 16-byte format.
+*/
+struct RegInstruction {
+    RegOpCode op_code;
+    ExprKind builtin; // call only
+    uint32_t dest;
+    uint32_t first_operand;
+    uint32_t operand_count;
+};
+
+class RegisterCode {
+    private:
+        std::vector<RegInstruction> code;
+        std::vector<uint64_t> positions;
+        std::vector<Operand> operands;
+        std::vector<ReturnValue> constants;
+        size_t register_count = 0;
+        size_t max_operand_count = 0;
+
+        friend class RegisterCompiler;
+    public:
+        const std::vector<RegInstruction>& get_code() const { return code; }
+
+        uint64_t get_position(size_t instruction) const { return positions[instruction]; }
+
+        const Operand& get_operand(size_t index) const { return operands[index]; }
+
+        const ReturnValue& get_constant(uint32_t index) const { return constants[index]; }
+
+        size_t get_register_count() const { return register_count; }
+
+        size_t get_max_operand_count() const { return max_operand_count; }
+
+        // One instruction per line, for debugging.
+        std::string to_string() const;
+};
+
+/*
+Compiles the AST to three-address code. Literals become constant operands and
+take no instruction. Identifiers too: the NameAnalyzer made sure a variable
+is set before it's read and never set again, so the instruction using it
+reads it in place from its slot.
+
+Registers are virtual while compiling, one per call result, then a linear scan
+over their live ranges (from the instruction defining a register to the one
+using it) assigns them to the fewest physical registers.
+*/
+class RegisterCompiler {
+    private:
+        struct LiveRange {
+            uint32_t start;
+            uint32_t end;
+        };
+
+        RegisterCode register_code;
+        std::vector<LiveRange> live_ranges; // indexed by virtual register
+        uint32_t null_constant = 0;
+
+        uint32_t emit(RegOpCode op_code, uint64_t position, const std::vector<Operand>& operands,
+                      ExprKind builtin = ExprKind::error);
+
+        uint32_t add_constant(ReturnValue constant);
+
+        uint32_t new_register(uint32_t instruction);
+
+        Operand compile_operand(Expr* expr);
+
+        void assign_registers();
+    public:
+        RegisterCode compile(Expr* root);
+};
+
+#endif // REGISTER_CODE_H
@@ -0,0 +1,58 @@
+#include "register_vm.h"
+#include "../interpreter/builtins.h"
+
+// Variables are read in place from the context.
+inline const ReturnValue& RegisterVM::read(
+    const RegisterCode& register_code,
+    size_t operand,
+    const Context& context
+) {
+    const Operand& source = register_code.get_operand(operand);
+    switch (source.kind) {
+        case OperandKind::reg:
+            return registers[source.index];
+        case OperandKind::constant:
+            return register_code.get_constant(source.index);
+        case OperandKind::variable:
+            break;
+    }
+    return context.get_var(source.index);
+}
+
+void RegisterVM::run(const RegisterCode& register_code, std::shared_ptr<Context> context, std::shared_ptr<Printer> printer) {
+    registers.assign(register_code.get_register_count(), ReturnValue());
+    arguments.resize(register_code.get_max_operand_count());
+    const std::vector<RegInstruction>& code = register_code.get_code();
+    for (size_t pc = 0; ; pc++) {
+        const RegInstruction& instruction = code[pc];
+        switch (instruction.op_code) {
+            case RegOpCode::call: {
+                for (uint32_t i = 0; i < instruction.operand_count; i++)
+                    arguments[i] = read(register_code, instruction.first_operand + i, *context);
+                registers[instruction.dest] = apply_builtin(
+                    instruction.builtin,
+                    ValueSpan(arguments.data(), instruction.operand_count),
+                    register_code.get_position(pc),
+                    *printer
+                );
+                break;
+            }
+            case RegOpCode::store_var: {
+                const Operand& target = register_code.get_operand(instruction.first_operand);
+                context->set_var(target.index, read(register_code, instruction.first_operand + 1, *context));
+                break;
+            }
+            case RegOpCode::puts: {
+                const ReturnValue& value = read(register_code, instruction.first_operand, *context);
+                if (value.get_type() != Type::string_type)
+                    throw ProgramError(register_code.get_position(pc));
+                printer->add_output(std::string(value.as_string()));
+                break;
+            }
+            case RegOpCode::fail:
+                throw ProgramError(register_code.get_position(pc));
+            case RegOpCode::halt:
+                return;
+        }
+    }
+}
@@ -0,0 +1,23 @@
+#ifndef REGISTER_VM_H
+#define REGISTER_VM_H
+
+#include <memory>
+#include <vector>
+#include "register_code.h"
+#include "../interpreter/interpreter.h"
+
+/*
+Executes RegisterCode. The register file and the argument buffer builtins read
+their operands from are sized once from the compiled code.
+*/
+class RegisterVM {
+    private:
+        std::vector<ReturnValue> registers;
+        std::vector<ReturnValue> arguments;
+
+        const ReturnValue& read(const RegisterCode& register_code, size_t operand, const Context& context);
+    public:
+        void run(const RegisterCode& register_code, std::shared_ptr<Context> context, std::shared_ptr<Printer> printer);
+};
+
+#endif // REGISTER_VM_H
@@ -0,0 +1,155 @@
+#include <algorithm>
+
+#include "stack_vm.h"
+#include "../interpreter/builtins.h"
+
+#if (defined(__GNUC__) || defined(__clang__)) && !defined(STACK_VM_SWITCH_ONLY)
+#define STACK_VM_THREADED 1
+#endif
+
+std::string dispatch_name(Dispatch dispatch) {
+    switch (dispatch) {
+        case Dispatch::switch_loop:
+            return "switch";
+        case Dispatch::threaded:
+            return "threaded";
+    }
+    return "unknown";
+}
+
+StackVM::StackVM() : StackVM(best_supported_dispatch()) { }
+
+StackVM::StackVM(Dispatch dispatch)
+    : dispatch(std::min(dispatch, best_supported_dispatch())), stack() { }
+
+Dispatch StackVM::best_supported_dispatch() {
+#ifdef STACK_VM_THREADED
+    return Dispatch::threaded;
+#else
+    return Dispatch::switch_loop;
+#endif
+}
+
+Dispatch StackVM::get_dispatch() const {
+    return dispatch;
+}
+
+inline void StackVM::push_constant(const Bytecode& bytecode, const Instruction& instruction) {
+    stack[top++] = bytecode.get_constant(instruction.operand);
+}
+
+inline void StackVM::load_var(const Instruction& instruction, const Context& context) {
+    stack[top++] = context.get_var(instruction.operand);
+}
+
+inline void StackVM::store_var(const Instruction& instruction, Context& context) {
+    context.set_var(instruction.operand, std::move(stack[top - 1]));
+    stack[top - 1] = ReturnValue();
+}
+
+inline void StackVM::call_builtin(const Bytecode& bytecode, const Instruction& instruction, size_t pc, Printer& printer) {
+    size_t argc = instruction.operand;
+    ReturnValue result = apply_builtin(
+        instruction.builtin, ValueSpan(&stack[top - argc], argc), bytecode.get_position(pc), printer
+    );
+    for (size_t i = 1; i < argc; i++)
+        stack[--top] = ReturnValue();
+    if (argc == 0)
+        top++;
+    stack[top - 1] = std::move(result);
+}
+
+inline void StackVM::puts(const Bytecode& bytecode, size_t pc, Printer& printer) {
+    if (stack[top - 1].get_type() != Type::string_type)
+        throw ProgramError(bytecode.get_position(pc));
+    printer.add_output(std::string(stack[top - 1].as_string()));
+    stack[top - 1] = ReturnValue();
+}
+
+inline void StackVM::pop() {
+    stack[--top] = ReturnValue();
+}
+
+void StackVM::run_switch(const Bytecode& bytecode, Context& context, Printer& printer) {
+    const Instruction* code = bytecode.get_code().data();
+    for (size_t pc = 0; ; pc++) {
+        const Instruction& instruction = code[pc];
+        switch (instruction.op_code) {
+            case OpCode::push_constant:
+                push_constant(bytecode, instruction);
+                break;
+            case OpCode::load_var:
+                load_var(instruction, context);
+                break;
+            case OpCode::store_var:
+                store_var(instruction, context);
+                break;
+            case OpCode::call_builtin:
+                call_builtin(bytecode, instruction, pc, printer);
+                break;
+            case OpCode::puts:
+                puts(bytecode, pc, printer);
+                break;
+            case OpCode::pop:
+                pop();
+                break;
+            case OpCode::fail:
+                throw ProgramError(bytecode.get_position(pc));
+            case OpCode::halt:
+                return;
+        }
+    }
+}
+
+/*
+Token threaded: the handler address is looked up from the opcode of the next
+instruction at the end of every handler, so each handler has its own indirect
+jump and the branch predictor learns opcode pairs instead of a single site.
+*/
+void StackVM::run_threaded(const Bytecode& bytecode, Context& context, Printer& printer) {
+#ifdef STACK_VM_THREADED
+    static const void* const handlers[] = {
+        &&op_push_constant, &&op_load_var, &&op_store_var, &&op_call_builtin, &&op_puts, &&op_pop, &&op_fail, &&op_halt
+    };
+    static_assert(sizeof(handlers) / sizeof(handlers[0]) == size_t(OpCode::halt) + 1, "a handler per opcode");
+    const Instruction* code = bytecode.get_code().data();
+    size_t pc = 0;
+    #define STACK_VM_NEXT goto *handlers[size_t(code[++pc].op_code)]
+    goto *handlers[size_t(code[pc].op_code)];
+op_push_constant:
+    push_constant(bytecode, code[pc]);
+    STACK_VM_NEXT;
+op_load_var:
+    load_var(code[pc], context);
+    STACK_VM_NEXT;
+op_store_var:
+    store_var(code[pc], context);
+    STACK_VM_NEXT;
+op_call_builtin:
+    call_builtin(bytecode, code[pc], pc, printer);
+    STACK_VM_NEXT;
+op_puts:
+    puts(bytecode, pc, printer);
+    STACK_VM_NEXT;
+op_pop:
+    pop();
+    STACK_VM_NEXT;
+op_fail:
+    throw ProgramError(bytecode.get_position(pc));
+op_halt:
+    return;
+    #undef STACK_VM_NEXT
+#else
+    run_switch(bytecode, context, printer);
+#endif
+}
+
+void StackVM::run(const Bytecode& bytecode, std::shared_ptr<Context> context, std::shared_ptr<Printer> printer) {
+    if (stack.size() < bytecode.get_max_stack_depth())
+        stack.resize(bytecode.get_max_stack_depth());
+    top = 0;
+    if (dispatch == Dispatch::threaded)
+        run_threaded(bytecode, *context, *printer);
+    else
+        run_switch(bytecode, *context, *printer);
+}
@@ -0,0 +1,66 @@
+#ifndef STACK_VM_H
+#define STACK_VM_H
+
+#include <memory>
+#include <string>
+#include <vector>
+#include "bytecode.h"
+#include "../interpreter/interpreter.h"
+
+/*
+How the VM jumps to the next instruction. threaded uses the GCC / Clang
+labels-as-values extension: every handler jumps straight to the handler of
+the next opcode through a table, instead of going back to a single switch.
+It's only compiled with those compilers (and not with STACK_VM_SWITCH_ONLY
+defined), elsewhere the switch loop is used.
+*/
+enum class Dispatch {
+    switch_loop,
+    threaded
+};
+
+std::string dispatch_name(Dispatch dispatch);
+
+/*
+Executes Bytecode on a value stack sized once from the compiler's maximum
+depth, so running a program doesn't grow it. Builtins read their operands
+in place as a slice of the stack.
+*/
+class StackVM {
+    private:
+        Dispatch dispatch;
+        std::vector<ReturnValue> stack;
+        size_t top = 0; // number of values on the stack
+
+        void run_switch(const Bytecode& bytecode, Context& context, Printer& printer);
+
+        void run_threaded(const Bytecode& bytecode, Context& context, Printer& printer);
+
+        // Opcode handlers, shared by both dispatch loops.
+
+        void push_constant(const Bytecode& bytecode, const Instruction& instruction);
+
+        void load_var(const Instruction& instruction, const Context& context);
+
+        void store_var(const Instruction& instruction, Context& context);
+
+        void call_builtin(const Bytecode& bytecode, const Instruction& instruction, size_t pc, Printer& printer);
+
+        void puts(const Bytecode& bytecode, size_t pc, Printer& printer);
+
+        void pop();
+    public:
+        // Fastest dispatch compiled in.
+        StackVM();
+
+        // Requested dispatch, threaded falls back to the switch loop if it isn't compiled in.
+        StackVM(Dispatch dispatch);
+
+        static Dispatch best_supported_dispatch();
+
+        Dispatch get_dispatch() const;
+
+        void run(const Bytecode& bytecode, std::shared_ptr<Context> context, std::shared_ptr<Printer> printer);
+};
+
+#endif // STACK_VM_H
@@ -1,12 +1,44 @@
 #include "core/interpreter/interpreter.h"
 
-int main() {
+#include <fstream>
+#include <string_view>
+
+// run_repl [--evaluator=tree|flat|vm|regvm] [file]
+int main(int argc, char** argv) {
     std::string input;
-    Interpreter interpreter;
+    Evaluator evaluator = Evaluator::tree_walker;
+    int arg = 1;
+    constexpr std::string_view evaluator_flag = "--evaluator=";
+    if (arg < argc && std::string_view(argv[arg]).substr(0, evaluator_flag.size()) == evaluator_flag) {
+        std::string_view name = std::string_view(argv[arg]).substr(evaluator_flag.size());
+        if (name == "tree")
+            evaluator = Evaluator::tree_walker;
+        else if (name == "flat")
+            evaluator = Evaluator::flat_ast;
+        else if (name == "vm")
+            evaluator = Evaluator::stack_vm;
+        else if (name == "regvm")
+            evaluator = Evaluator::register_vm;
+        else {
+            std::cerr << "Unknown evaluator " << name << ", expected tree, flat, vm or regvm\n";
+            return 1;
+        }
+        arg++;
+    }
+    Interpreter interpreter(evaluator);
+    if (arg < argc) { // run a program file, streamed in chunks
+        std::ifstream file(argv[arg], std::ios::binary);
+        if (!file) {
+            std::cerr << "Cannot open " << argv[arg] << "\n";
+            return 1;
+        }
+        interpreter.interpret_stream(file, std::cout);
+        return 0;
+    }
     std::shared_ptr<Context> context = std::make_shared<Context>();
     std::shared_ptr<Printer> printer = std::make_shared<Printer>();
 
     while (std::getline(std::cin, input)) {
         interpreter.repl_iteration(input, context, printer);
     }
-}
\ No newline at end of file
+}
@@ -0,0 +1,406 @@
+#include <algorithm>
+#include <cstring>
+#include "byte_scanner.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define BYTE_SCANNER_X86 1
+#include <immintrin.h>
+#endif
+
+
+namespace {
+
+inline bool is_whitespace(unsigned char c) {
+    return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+// Scalar kernels
+
+size_t skip_whitespace_scalar(const char* data, size_t pos, size_t size) {
+    while (pos < size && is_whitespace(data[pos]))
+        pos++;
+    return pos;
+}
+
+size_t find_quote_scalar(const char* data, size_t pos, size_t size) {
+    while (pos < size && data[pos] != '"')
+        pos++;
+    return pos;
+}
+
+size_t find_newline_scalar(const char* data, size_t pos, size_t size) {
+    while (pos < size && data[pos] != '\n')
+        pos++;
+    return pos;
+}
+
+size_t count_newlines_scalar(const char* data, size_t pos, size_t size) {
+    size_t count = 0;
+    for (; pos < size; pos++)
+        count += (data[pos] == '\n');
+    return count;
+}
+
+size_t find_paren_or_quote_scalar(const char* data, size_t pos, size_t size) {
+    while (pos < size && data[pos] != '(' && data[pos] != ')' && data[pos] != '"')
+        pos++;
+    return pos;
+}
+
+// Candidates are found with memchr on the first byte (vectorized by the C
+// library) and checked on the last byte before the whole pattern is compared.
+size_t find_substring_scalar(const char* data, size_t pos, size_t size, const char* pattern, size_t length) {
+    while (pos + length <= size) {
+        const char* hit = static_cast<const char*>(std::memchr(data + pos, pattern[0], size - length + 1 - pos));
+        if (!hit)
+            return size;
+        pos = hit - data;
+        if (data[pos + length - 1] == pattern[length - 1] && std::memcmp(data + pos, pattern, length) == 0)
+            return pos;
+        pos++;
+    }
+    return size;
+}
+
+// Bytes in [first, first + 26) are letters of the case being converted,
+// flipping bit 5 switches their case. Everything else is copied, including
+// the bytes of non-ASCII characters.
+void convert_case_scalar(const char* data, size_t pos, size_t size, char* destination, char first) {
+    for (; pos < size; pos++) {
+        unsigned char c = data[pos];
+        destination[pos] = static_cast<char>(c ^ (static_cast<unsigned char>(c - first) < 26 ? 0x20 : 0));
+    }
+}
+
+#ifdef BYTE_SCANNER_X86
+
+// SSE2 kernels, 16 bytes per step, the tail is handled by the scalar code
+
+inline __m128i whitespace_mask_sse2(__m128i block) {
+    // ' ' or '\t' <= c <= '\r'
+    __m128i shifted = _mm_sub_epi8(block, _mm_set1_epi8('\t'));
+    __m128i in_range = _mm_cmpeq_epi8(_mm_min_epu8(shifted, _mm_set1_epi8('\r' - '\t')), shifted);
+    return _mm_or_si128(in_range, _mm_cmpeq_epi8(block, _mm_set1_epi8(' ')));
+}
+
+size_t skip_whitespace_sse2(const char* data, size_t pos, size_t size) {
+    for (; pos + 16 <= size; pos += 16) {
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos));
+        unsigned mask = ~unsigned(_mm_movemask_epi8(whitespace_mask_sse2(block))) & 0xFFFFu;
+        if (mask)
+            return pos + __builtin_ctz(mask);
+    }
+    return skip_whitespace_scalar(data, pos, size);
+}
+
+size_t find_quote_sse2(const char* data, size_t pos, size_t size) {
+    const __m128i quote = _mm_set1_epi8('"');
+    for (; pos + 16 <= size; pos += 16) {
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos));
+        unsigned mask = _mm_movemask_epi8(_mm_cmpeq_epi8(block, quote));
+        if (mask)
+            return pos + __builtin_ctz(mask);
+    }
+    return find_quote_scalar(data, pos, size);
+}
+
+size_t find_newline_sse2(const char* data, size_t pos, size_t size) {
+    const __m128i newline = _mm_set1_epi8('\n');
+    for (; pos + 16 <= size; pos += 16) {
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos));
+        unsigned mask = _mm_movemask_epi8(_mm_cmpeq_epi8(block, newline));
+        if (mask)
+            return pos + __builtin_ctz(mask);
+    }
+    return find_newline_scalar(data, pos, size);
+}
+
+size_t count_newlines_sse2(const char* data, size_t pos, size_t size) {
+    const __m128i newline = _mm_set1_epi8('\n');
+    size_t count = 0;
+    for (; pos + 16 <= size; pos += 16) {
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos));
+        count += __builtin_popcount(_mm_movemask_epi8(_mm_cmpeq_epi8(block, newline)));
+    }
+    return count + count_newlines_scalar(data, pos, size);
+}
+
+size_t find_paren_or_quote_sse2(const char* data, size_t pos, size_t size) {
+    const __m128i open = _mm_set1_epi8('('), close = _mm_set1_epi8(')'), quote = _mm_set1_epi8('"');
+    for (; pos + 16 <= size; pos += 16) {
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos));
+        __m128i hits = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(block, open), _mm_cmpeq_epi8(block, close)),
+            _mm_cmpeq_epi8(block, quote)
+        );
+        unsigned mask = _mm_movemask_epi8(hits);
+        if (mask)
+            return pos + __builtin_ctz(mask);
+    }
+    return find_paren_or_quote_scalar(data, pos, size);
+}
+
+// Positions where both the first and the last byte of the pattern match are
+// candidates, 16 at a time; the pattern is at least 2 bytes long.
+size_t find_substring_sse2(const char* data, size_t pos, size_t size, const char* pattern, size_t length) {
+    const __m128i first = _mm_set1_epi8(pattern[0]), last = _mm_set1_epi8(pattern[length - 1]);
+    for (; pos + length - 1 + 16 <= size; pos += 16) {
+        __m128i block_first = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos));
+        __m128i block_last = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos + length - 1));
+        unsigned mask = _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(block_first, first), _mm_cmpeq_epi8(block_last, last)));
+        for (; mask; mask &= mask - 1) {
+            size_t candidate = pos + __builtin_ctz(mask);
+            if (std::memcmp(data + candidate + 1, pattern + 1, length - 2) == 0)
+                return candidate;
+        }
+    }
+    return find_substring_scalar(data, pos, size, pattern, length);
+}
+
+void convert_case_sse2(const char* data, size_t pos, size_t size, char* destination, char first) {
+    const __m128i shift = _mm_set1_epi8(first), range = _mm_set1_epi8(25), flip = _mm_set1_epi8(0x20);
+    for (; pos + 16 <= size; pos += 16) {
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos));
+        __m128i shifted = _mm_sub_epi8(block, shift);
+        __m128i letters = _mm_cmpeq_epi8(_mm_min_epu8(shifted, range), shifted);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + pos), _mm_xor_si128(block, _mm_and_si128(letters, flip)));
+    }
+    convert_case_scalar(data, pos, size, destination, first);
+}
+
+// AVX2 kernels, 32 bytes per step, the tail is handled by the SSE2 code
+
+__attribute__((target("avx2")))
+size_t skip_whitespace_avx2(const char* data, size_t pos, size_t size) {
+    const __m256i tab = _mm256_set1_epi8('\t'), range = _mm256_set1_epi8('\r' - '\t'), space = _mm256_set1_epi8(' ');
+    for (; pos + 32 <= size; pos += 32) {
+        __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + pos));
+        __m256i shifted = _mm256_sub_epi8(block, tab);
+        __m256i in_range = _mm256_cmpeq_epi8(_mm256_min_epu8(shifted, range), shifted);
+        __m256i whitespace = _mm256_or_si256(in_range, _mm256_cmpeq_epi8(block, space));
+        unsigned mask = ~unsigned(_mm256_movemask_epi8(whitespace));
+        if (mask)
+            return pos + __builtin_ctz(mask);
+    }
+    return skip_whitespace_sse2(data, pos, size);
+}
+
+__attribute__((target("avx2")))
+size_t find_quote_avx2(const char* data, size_t pos, size_t size) {
+    const __m256i quote = _mm256_set1_epi8('"');
+    for (; pos + 32 <= size; pos += 32) {
+        __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + pos));
+        unsigned mask = _mm256_movemask_epi8(_mm256_cmpeq_epi8(block, quote));
+        if (mask)
+            return pos + __builtin_ctz(mask);
+    }
+    return find_quote_sse2(data, pos, size);
+}
+
+__attribute__((target("avx2")))
+size_t find_newline_avx2(const char* data, size_t pos, size_t size) {
+    const __m256i newline = _mm256_set1_epi8('\n');
+    for (; pos + 32 <= size; pos += 32) {
+        __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + pos));
+        unsigned mask = _mm256_movemask_epi8(_mm256_cmpeq_epi8(block, newline));
+        if (mask)
+            return pos + __builtin_ctz(mask);
+    }
+    return find_newline_sse2(data, pos, size);
+}
+
+__attribute__((target("avx2")))
+size_t count_newlines_avx2(const char* data, size_t pos, size_t size) {
+    const __m256i newline = _mm256_set1_epi8('\n');
+    size_t count = 0;
+    for (; pos + 32 <= size; pos += 32) {
+        __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + pos));
+        count += __builtin_popcount(_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, newline)));
+    }
+    return count + count_newlines_sse2(data, pos, size);
+}
+
+__attribute__((target("avx2")))
+size_t find_paren_or_quote_avx2(const char* data, size_t pos, size_t size) {
+    const __m256i open = _mm256_set1_epi8('('), close = _mm256_set1_epi8(')'), quote = _mm256_set1_epi8('"');
+    for (; pos + 32 <= size; pos += 32) {
+        __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + pos));
+        __m256i hits = _mm256_or_si256(
+            _mm256_or_si256(_mm256_cmpeq_epi8(block, open), _mm256_cmpeq_epi8(block, close)),
+            _mm256_cmpeq_epi8(block, quote)
+        );
+        unsigned mask = _mm256_movemask_epi8(hits);
+        if (mask)
+            return pos + __builtin_ctz(mask);
+    }
+    return find_paren_or_quote_sse2(data, pos, size);
+}
+
+__attribute__((target("avx2")))
+size_t find_substring_avx2(const char* data, size_t pos, size_t size, const char* pattern, size_t length) {
+    const __m256i first = _mm256_set1_epi8(pattern[0]), last = _mm256_set1_epi8(pattern[length - 1]);
+    for (; pos + length - 1 + 32 <= size; pos += 32) {
+        __m256i block_first = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + pos));
+        __m256i block_last = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + pos + length - 1));
+        unsigned mask = _mm256_movemask_epi8(
+            _mm256_and_si256(_mm256_cmpeq_epi8(block_first, first), _mm256_cmpeq_epi8(block_last, last))
+        );
+        for (; mask; mask &= mask - 1) {
+            size_t candidate = pos + __builtin_ctz(mask);
+            if (std::memcmp(data + candidate + 1, pattern + 1, length - 2) == 0)
+                return candidate;
+        }
+    }
+    return find_substring_sse2(data, pos, size, pattern, length);
+}
+
+__attribute__((target("avx2")))
+void convert_case_avx2(const char* data, size_t pos, size_t size, char* destination, char first) {
+    const __m256i shift = _mm256_set1_epi8(first), range = _mm256_set1_epi8(25), flip = _mm256_set1_epi8(0x20);
+    for (; pos + 32 <= size; pos += 32) {
+        __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + pos));
+        __m256i shifted = _mm256_sub_epi8(block, shift);
+        __m256i letters = _mm256_cmpeq_epi8(_mm256_min_epu8(shifted, range), shifted);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(destination + pos), _mm256_xor_si256(block, _mm256_and_si256(letters, flip)));
+    }
+    convert_case_sse2(data, pos, size, destination, first);
+}
+
+#endif // BYTE_SCANNER_X86
+
+void convert_case(SimdLevel level, std::string_view text, char* destination, char first) {
+    switch (level) {
+#ifdef BYTE_SCANNER_X86
+        case SimdLevel::avx2:
+            return convert_case_avx2(text.data(), 0, text.size(), destination, first);
+        case SimdLevel::sse2:
+            return convert_case_sse2(text.data(), 0, text.size(), destination, first);
+#endif
+        default:
+            return convert_case_scalar(text.data(), 0, text.size(), destination, first);
+    }
+}
+
+}
+
+
+std::string simd_level_name(SimdLevel level) {
+    switch (level) {
+        case SimdLevel::scalar:
+            return "scalar";
+        case SimdLevel::sse2:
+            return "sse2";
+        case SimdLevel::avx2:
+            return "avx2";
+    }
+    return "unknown";
+}
+
+ByteScanner::ByteScanner() : level(best_supported_level()) { }
+
+ByteScanner::ByteScanner(SimdLevel level) : level(std::min(level, best_supported_level())) { }
+
+SimdLevel ByteScanner::best_supported_level() {
+#ifdef BYTE_SCANNER_X86
+    static const SimdLevel best = __builtin_cpu_supports("avx2") ? SimdLevel::avx2 : SimdLevel::sse2;
+    return best;
+#else
+    return SimdLevel::scalar;
+#endif
+}
+
+SimdLevel ByteScanner::get_level() const {
+    return level;
+}
+
+size_t ByteScanner::skip_whitespace(std::string_view text, size_t pos) const {
+    switch (level) {
+#ifdef BYTE_SCANNER_X86
+        case SimdLevel::avx2:
+            return skip_whitespace_avx2(text.data(), pos, text.size());
+        case SimdLevel::sse2:
+            return skip_whitespace_sse2(text.data(), pos, text.size());
+#endif
+        default:
+            return skip_whitespace_scalar(text.data(), pos, text.size());
+    }
+}
+
+size_t ByteScanner::find_quote(std::string_view text, size_t pos) const {
+    switch (level) {
+#ifdef BYTE_SCANNER_X86
+        case SimdLevel::avx2:
+            return find_quote_avx2(text.data(), pos, text.size());
+        case SimdLevel::sse2:
+            return find_quote_sse2(text.data(), pos, text.size());
+#endif
+        default:
+            return find_quote_scalar(text.data(), pos, text.size());
+    }
+}
+
+size_t ByteScanner::find_paren_or_quote(std::string_view text, size_t pos) const {
+    switch (level) {
+#ifdef BYTE_SCANNER_X86
+        case SimdLevel::avx2:
+            return find_paren_or_quote_avx2(text.data(), pos, text.size());
+        case SimdLevel::sse2:
+            return find_paren_or_quote_sse2(text.data(), pos, text.size());
+#endif
+        default:
+            return find_paren_or_quote_scalar(text.data(), pos, text.size());
+    }
+}
+
+size_t ByteScanner::find_newline(std::string_view text, size_t pos) const {
+    switch (level) {
+#ifdef BYTE_SCANNER_X86
+        case SimdLevel::avx2:
+            return find_newline_avx2(text.data(), pos, text.size());
+        case SimdLevel::sse2:
+            return find_newline_sse2(text.data(), pos, text.size());
+#endif
+        default:
+            return find_newline_scalar(text.data(), pos, text.size());
+    }
+}
+
+size_t ByteScanner::count_newlines(std::string_view text, size_t pos) const {
+    switch (level) {
+#ifdef BYTE_SCANNER_X86
+        case SimdLevel::avx2:
+            return count_newlines_avx2(text.data(), pos, text.size());
+        case SimdLevel::sse2:
+            return count_newlines_sse2(text.data(), pos, text.size());
+#endif
+        default:
+            return count_newlines_scalar(text.data(), pos, text.size());
+    }
+}
+
+size_t ByteScanner::find_substring(std::string_view text, std::string_view pattern, size_t pos) const {
+    if (pattern.empty() || pos >= text.size())
+        return text.size();
+    if (pattern.size() == 1) {
+        const void* hit = std::memchr(text.data() + pos, pattern[0], text.size() - pos);
+        return hit ? static_cast<const char*>(hit) - text.data() : text.size();
+    }
+    switch (level) {
+#ifdef BYTE_SCANNER_X86
+        case SimdLevel::avx2:
+            return find_substring_avx2(text.data(), pos, text.size(), pattern.data(), pattern.size());
+        case SimdLevel::sse2:
+            return find_substring_sse2(text.data(), pos, text.size(), pattern.data(), pattern.size());
+#endif
+        default:
+            return find_substring_scalar(text.data(), pos, text.size(), pattern.data(), pattern.size());
+    }
+}
+
+void ByteScanner::to_lowercase(std::string_view text, char* destination) const {
+    convert_case(level, text, destination, 'A');
+}
+
+void ByteScanner::to_uppercase(std::string_view text, char* destination) const {
+    convert_case(level, text, destination, 'a');
+}
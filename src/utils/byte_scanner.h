@@ -0,0 +1,66 @@
+#ifndef BYTE_SCANNER_H
+#define BYTE_SCANNER_H
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+/*
+Vectorized byte scanning kernels used by the lexer fast paths and by the
+string builtins.
+
+Every kernel has a portable scalar version and SSE2 / AVX2 versions, the
+widest one supported by the CPU is picked at runtime (x86 only, other
+targets always use the scalar code).
+*/
+
+enum class SimdLevel {
+    scalar,
+    sse2,
+    avx2
+};
+
+std::string simd_level_name(SimdLevel level);
+
+class ByteScanner {
+    private:
+        SimdLevel level;
+    public:
+        // Best level supported by the CPU.
+        ByteScanner();
+
+        // Requested level, capped at what the CPU supports.
+        ByteScanner(SimdLevel level);
+
+        static SimdLevel best_supported_level();
+
+        SimdLevel get_level() const;
+
+        // Position of the first non whitespace byte at or after pos (text.size() if none).
+        size_t skip_whitespace(std::string_view text, size_t pos) const;
+
+        // Position of the first '"' at or after pos (text.size() if none).
+        size_t find_quote(std::string_view text, size_t pos) const;
+
+        // Position of the first '(', ')' or '"' at or after pos (text.size() if none).
+        size_t find_paren_or_quote(std::string_view text, size_t pos) const;
+
+        // Position of the first '\n' at or after pos (text.size() if none).
+        size_t find_newline(std::string_view text, size_t pos) const;
+
+        // Number of '\n' at or after pos.
+        size_t count_newlines(std::string_view text, size_t pos) const;
+
+        // Position of the first occurrence of pattern at or after pos (text.size() if none,
+        // or if the pattern is empty).
+        size_t find_substring(std::string_view text, std::string_view pattern, size_t pos) const;
+
+        // Writes text with its ASCII letters in lowercase (uppercase) to destination,
+        // which has room for text.size() bytes. Other bytes, non-ASCII ones
+        // included, are copied unchanged, whatever the locale.
+        void to_lowercase(std::string_view text, char* destination) const;
+
+        void to_uppercase(std::string_view text, char* destination) const;
+};
+
+#endif // BYTE_SCANNER_H
@@ -0,0 +1,14 @@
+#include <algorithm>
+#include "line_index.h"
+
+LineIndex::LineIndex(std::string_view text) : text(text) { }
+
+size_t LineIndex::line_of(uint64_t offset) {
+    if (line_starts.empty()) {
+        line_starts.reserve(byte_scanner.count_newlines(text, 0) + 1);
+        line_starts.push_back(0);
+        for (size_t pos = byte_scanner.find_newline(text, 0); pos < text.size(); pos = byte_scanner.find_newline(text, pos + 1))
+            line_starts.push_back(pos + 1);
+    }
+    return std::upper_bound(line_starts.begin(), line_starts.end(), offset) - line_starts.begin();
+}
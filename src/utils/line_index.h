@@ -0,0 +1,27 @@
+#ifndef LINE_INDEX_H
+#define LINE_INDEX_H
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+#include "byte_scanner.h"
+
+/*
+Byte offset to line number conversion. Tokens and AST nodes only carry byte
+offsets, the offsets of the line starts are collected on the first lookup
+(an error is being reported) and each lookup is a binary search.
+*/
+class LineIndex {
+    private:
+        std::string_view text;
+        ByteScanner byte_scanner;
+        std::vector<size_t> line_starts;
+    public:
+        // The text has to outlive the index.
+        LineIndex(std::string_view text);
+
+        // 1-based line of the byte at offset.
+        size_t line_of(uint64_t offset);
+};
+
+#endif // LINE_INDEX_H
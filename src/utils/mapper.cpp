@@ -1,126 +1,82 @@
+#include <cassert>
+#include <climits>
 #include <memory>
 
 #include "mapper.h"
+#include "program_error.h"
 
 
 
 
-std::shared_ptr<Expr> SymbolToExprMapper::operator()(std::shared_ptr<Symbol> symbol) {
-    ExprCreator expr_creator;
-    std::string symbol_str = symbol->get_symbol_str();
-    if (symbol_str == "Params") {
-        return expr_creator("ParseTempExpr(Params)");
-    }
-    else if(symbol_str == "Params\'") {
-        return expr_creator("ParseTempExpr(Params\')");
-    }
-    else if (symbol_str == "Literal") {
-        return expr_creator("ParseTempExpr(Literal)");
-    } 
-    else if (symbol_str == "Program") {
-        return expr_creator("ParseTempExpr(Program)");
-    }
-    else if(symbol_str == "Program\'") {
-        return expr_creator("ParseTempExpr(Program\')");
-    }
-    else if( symbol_str == "Expr") {
-        return expr_creator("ParseTempExpr(Expr)");
-    }
-    return expr_creator(symbol->get_symbol_str());
-}
-
-
-std::shared_ptr<Symbol> TokenToSymbolMapper::operator()(std::shared_ptr<Token> token) {
-    std::string token_type = token->get_type();
-    
-    if (token_type == "DelimiterToken") {
-        return std::make_shared<TerminalSymbol>(token->to_string()); // TODO FIX LATER IMPLEMENT SEPARATE MODEL FOR IT
-    }
-    
-    return std::make_shared<TerminalSymbol>(token_type.substr(0, token_type.size() - 5)); // Remove "Token"
-}
+// Nonterminals become parse temporaries, terminals are placeholders
+// that get replaced by the token's expression once it's matched.
+SymbolToExprMapper::SymbolToExprMapper(AstArena& arena) : arena(arena) { }
 
-
-std::shared_ptr<Expr> TokenToExprMapper::operator()(std::shared_ptr<Token> token) {
-    if (token->get_type() == "KeywordToken") {
-        return (*this)(std::dynamic_pointer_cast<KeywordToken>(token));
-    }
-    else if (token->get_type() == "IdentifierToken") {
-        return (*this)(std::dynamic_pointer_cast<IdentifierToken>(token));
-    }
-    else if (token->get_type() == "StringLitToken") {
-        return (*this)(std::dynamic_pointer_cast<StringLitToken>(token));
-    }
-    else if (token->get_type() == "DelimiterToken") {
-        return (*this)(std::dynamic_pointer_cast<DelimiterToken>(token));
-    }
-    else if (token->get_type() == "ErrorToken") {
-        return (*this)(std::dynamic_pointer_cast<ErrorToken>(token));
-    }
-    else if (token->get_type() == "IntLitToken") {
-        return (*this)(std::dynamic_pointer_cast<IntLitToken>(token));
+Expr* SymbolToExprMapper::operator()(GrammarSymbol symbol) {
+    ExprCreator expr_creator(arena);
+    switch (symbol) {
+        case GrammarSymbol::params:
+            return expr_creator("ParseTempExpr(Params)");
+        case GrammarSymbol::params_prime:
+            return expr_creator("ParseTempExpr(Params\')");
+        case GrammarSymbol::literal:
+            return expr_creator("ParseTempExpr(Literal)");
+        case GrammarSymbol::program:
+            return expr_creator("ParseTempExpr(Program)");
+        case GrammarSymbol::program_prime:
+            return expr_creator("ParseTempExpr(Program\')");
+        case GrammarSymbol::expr:
+            return expr_creator("ParseTempExpr(Expr)");
+        default:
+            return nullptr;
     }
-    else if (token->get_type() == "FloatLitToken") {
-        return (*this)(std::dynamic_pointer_cast<FloatLitToken>(token));
-    }
-    else if (token->get_type() == "BoolLitToken") {
-        return (*this)(std::dynamic_pointer_cast<BoolLitToken>(token));
-    }
-    else if (token->get_type() == "NullLitToken") {
-        return (*this)(std::dynamic_pointer_cast<NullLitToken>(token));
-    }
-    else if (token->get_type() == "SpaceToken") {
-        return (*this)(std::dynamic_pointer_cast<SpaceToken>(token));
-    }
-    else if (token->get_type() == "EOFToken") {
-        return (*this)(std::dynamic_pointer_cast<EOFToken>(token));
-    } else {
-        assert(0);
-    }
-}
-
-
-std::shared_ptr<Expr> TokenToExprMapper::operator()(std::shared_ptr<KeywordToken> token) {
-    ExprCreator expr_creator;
-    return ExprCreator()("Keyword(" + token->get_value() + ")");
 }
 
-std::shared_ptr<Expr> TokenToExprMapper::operator()(std::shared_ptr<IdentifierToken> token) {
-    return std::make_shared<IdentifierExpr>(token->get_value());
-}
-
-std::shared_ptr<Expr> TokenToExprMapper::operator()(std::shared_ptr<StringLitToken> token){
-    return std::make_shared<StringLiteral>(token->get_value());
-}
-
-std::shared_ptr<Expr> TokenToExprMapper::operator()(std::shared_ptr<DelimiterToken> token) {
-    return ExprCreator()("ParseTempExpr");
-}
 
-std::shared_ptr<Expr> TokenToExprMapper::operator()(std::shared_ptr<ErrorToken> token) {
-    return std::make_shared<ErrorExpr>(token->get_value());
+GrammarSymbol TokenToSymbolMapper::operator()(const Token& token, std::string_view text) {
+    return terminal_of(token, text);
 }
 
-std::shared_ptr<Expr> TokenToExprMapper::operator()(std::shared_ptr<IntLitToken> token) {
-    return std::make_shared<IntLiteral>(token->get_value());
-}
 
-std::shared_ptr<Expr> TokenToExprMapper::operator()(std::shared_ptr<FloatLitToken> token) {
-    return std::make_shared<FloatLiteral>(token->get_value());
+namespace {
+
+Expr* token_to_expr(AstArena& arena, const Token& token, std::string_view text) {
+    switch (token.kind) {
+        case TokenKind::keyword:
+            return ExprCreator(arena)(token.keyword_value);
+        case TokenKind::identifier:
+            return arena.create<IdentifierExpr>(arena.copy_string(text));
+        case TokenKind::string_lit:
+            return arena.create<StringLiteral>(arena.copy_string(text)); // the only copy of the literal
+        case TokenKind::error:
+            return arena.create<ErrorExpr>(arena.copy_string(text));
+        case TokenKind::int_lit:
+            // Tokens hold 64 bits, runtime ints only 32: the evaluators narrow
+            // literals without checking, so out of range ones are rejected here.
+            if (token.int_value < INT_MIN || token.int_value > INT_MAX)
+                throw ProgramError(token.position);
+            return arena.create<IntLiteral>(token.int_value);
+        case TokenKind::float_lit:
+            return arena.create<FloatLiteral>(token.float_value);
+        case TokenKind::bool_lit:
+            return arena.create<BoolLiteral>(token.bool_value);
+        case TokenKind::null_lit:
+            return arena.create<NullLiteral>();
+        case TokenKind::delimiter:
+        case TokenKind::space:
+        case TokenKind::eof:
+            return ExprCreator(arena)("ParseTempExpr");
+    }
+    assert(0);
+    return nullptr;
 }
 
-std::shared_ptr<Expr> TokenToExprMapper::operator()(std::shared_ptr<BoolLitToken> token) {
-    return std::make_shared<BoolLiteral>(token->get_value());
 }
 
-std::shared_ptr<Expr> TokenToExprMapper::operator()(std::shared_ptr<NullLitToken> token) {
-    return std::make_shared<NullLiteral>();
-}
+TokenToExprMapper::TokenToExprMapper(AstArena& arena) : arena(arena) { }
 
-std::shared_ptr<Expr> TokenToExprMapper::operator()(std::shared_ptr<SpaceToken> token) {
-    return ExprCreator()("ParseTempExpr");
+Expr* TokenToExprMapper::operator()(const Token& token, std::string_view text) {
+    Expr* expr = token_to_expr(arena, token, text);
+    expr->set_position(token.position); // function calls get the position of their keyword
+    return expr;
 }
-
-std::shared_ptr<Expr> TokenToExprMapper::operator()(std::shared_ptr<EOFToken> token) {
-    return ExprCreator()("ParseTempExpr");
-}
\ No newline at end of file
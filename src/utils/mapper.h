@@ -10,48 +10,33 @@ And from tokens to AST Nodes
 #include <vector>
 
 #include "../core/lexer/tokens.h"
-#include "../core/parser/symbol.h"
+#include "../core/parser/grammar.h"
 #include "../core/ast/tree_module.h"
 
 class TokenToSymbolMapper {
     private:
     public:
-        std::shared_ptr<Symbol> operator()(std::shared_ptr<Token> symbol);
+        GrammarSymbol operator()(const Token& token, std::string_view text);
 };
 
+// Nodes are created in the given arena, string payloads are copied into it.
 class TokenToExprMapper {
     private:
+        AstArena& arena;
     public:
-        std::shared_ptr<Expr> operator()(std::shared_ptr<KeywordToken> symbol);
+        TokenToExprMapper(AstArena& arena);
 
-        std::shared_ptr<Expr> operator()(std::shared_ptr<IdentifierToken> symbol);
-
-        std::shared_ptr<Expr> operator()(std::shared_ptr<StringLitToken> symbol);
-
-        std::shared_ptr<Expr> operator()(std::shared_ptr<DelimiterToken> symbol);
-
-        std::shared_ptr<Expr> operator()(std::shared_ptr<ErrorToken> symbol);
-
-        std::shared_ptr<Expr> operator()(std::shared_ptr<IntLitToken> symbol);
-
-        std::shared_ptr<Expr> operator()(std::shared_ptr<FloatLitToken> symbol);
-
-        std::shared_ptr<Expr> operator()(std::shared_ptr<BoolLitToken> symbol);
-
-        std::shared_ptr<Expr> operator()(std::shared_ptr<NullLitToken> symbol);
-
-        std::shared_ptr<Expr> operator()(std::shared_ptr<SpaceToken> symbol);
-
-        std::shared_ptr<Expr> operator()(std::shared_ptr<EOFToken> symbol);
-        
-        std::shared_ptr<Expr> operator()(std::shared_ptr<Token> symbol);
+        Expr* operator()(const Token& token, std::string_view text);
 };
 
 
 class SymbolToExprMapper {
     private:
+        AstArena& arena;
     public:
-        std::shared_ptr<Expr> operator()(std::shared_ptr<Symbol> symbol);
+        SymbolToExprMapper(AstArena& arena);
+
+        Expr* operator()(GrammarSymbol symbol);
 };
 
 
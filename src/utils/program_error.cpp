@@ -0,0 +1,7 @@
+#include "program_error.h"
+
+ProgramError::ProgramError(uint64_t position) : std::runtime_error("Incorrect program."), position(position) { }
+
+uint64_t ProgramError::get_position() const {
+    return position;
+}
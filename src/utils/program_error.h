@@ -0,0 +1,19 @@
+#ifndef PROGRAM_ERROR_H
+#define PROGRAM_ERROR_H
+
+#include <cstdint>
+#include <stdexcept>
+
+// Error of the interpreted program (lexing, parsing or evaluation). It only
+// records the byte offset where it was raised, the line number is resolved
+// when the error is reported (see LineIndex).
+class ProgramError : public std::runtime_error {
+    private:
+        uint64_t position;
+    public:
+        ProgramError(uint64_t position);
+
+        uint64_t get_position() const;
+};
+
+#endif // PROGRAM_ERROR_H
@@ -0,0 +1,111 @@
+#include <algorithm>
+#include <cstring>
+
+#include "substring_search.h"
+
+namespace {
+
+constexpr size_t npos = static_cast<size_t>(-1);
+
+// Start of the maximal suffix of pattern for the byte order (reversed or
+// not), and its period. Starts at npos, which wraps to 0 when offset.
+std::pair<size_t, size_t> maximal_suffix(std::string_view pattern, bool reversed) {
+    size_t suffix = npos, j = 0, k = 1, period = 1;
+    while (j + k < pattern.size()) {
+        unsigned char a = pattern[j + k], b = pattern[suffix + k];
+        if (reversed ? b < a : a < b) {
+            j += k;
+            k = 1;
+            period = j - suffix;
+        }
+        else if (a == b) {
+            if (k != period) {
+                k++;
+            }
+            else {
+                j += period;
+                k = 1;
+            }
+        }
+        else {
+            suffix = j++;
+            k = period = 1;
+        }
+    }
+    return {suffix + 1, period};
+}
+
+}
+
+SubstringSearcher::SubstringSearcher(std::string_view pattern, ByteScanner byte_scanner)
+    : pattern(pattern), byte_scanner(byte_scanner), critical_pos(0), period(0), periodic(false), shifts() {
+    if (pattern.size() >= min_two_way_size)
+        factorize();
+}
+
+// Critical factorization of the pattern (Crochemore and Perrin), the later
+// of the two maximal suffixes.
+void SubstringSearcher::factorize() {
+    auto [forward_pos, forward_period] = maximal_suffix(pattern, false);
+    auto [reversed_pos, reversed_period] = maximal_suffix(pattern, true);
+    critical_pos = std::max(forward_pos, reversed_pos);
+    period = forward_pos >= reversed_pos ? forward_period : reversed_period;
+    periodic = std::memcmp(pattern.data(), pattern.data() + period, critical_pos) == 0;
+    if (!periodic)
+        period = std::max(critical_pos, pattern.size() - critical_pos) + 1;
+    shifts.fill(pattern.size());
+    for (size_t i = 0; i < pattern.size(); i++)
+        shifts[static_cast<unsigned char>(pattern[i])] = pattern.size() - 1 - i;
+}
+
+// The right part is compared left to right, then the left part right to
+// left. A periodic pattern remembers how much of the window is known to
+// match after a shift by the period, which keeps the search linear.
+size_t SubstringSearcher::find_two_way(std::string_view text, size_t pos) const {
+    const char* data = text.data();
+    size_t length = pattern.size();
+    size_t memory = 0;
+    while (pos + length <= text.size()) {
+        size_t shift = shifts[static_cast<unsigned char>(data[pos + length - 1])];
+        if (shift > 0) {
+            // A periodic pattern whose last period didn't match can't match
+            // before the mismatching byte.
+            if (memory && shift < period)
+                shift = length - period;
+            memory = 0;
+            pos += shift;
+            continue;
+        }
+        size_t i = std::max(critical_pos, memory);
+        while (i < length - 1 && pattern[i] == data[pos + i])
+            i++;
+        if (i < length - 1) {
+            pos += i - critical_pos + 1;
+            memory = 0;
+            continue;
+        }
+        i = critical_pos;
+        while (i > memory && pattern[i - 1] == data[pos + i - 1])
+            i--;
+        if (i <= memory)
+            return pos;
+        pos += period;
+        memory = periodic ? length - period : 0;
+    }
+    return text.size();
+}
+
+size_t SubstringSearcher::find(std::string_view text, size_t pos) const {
+    if (pattern.size() >= min_two_way_size)
+        return find_two_way(text, pos);
+    return byte_scanner.find_substring(text, pattern, pos);
+}
+
+std::vector<size_t> SubstringSearcher::find_all(std::string_view text) const {
+    std::vector<size_t> positions;
+    if (pattern.empty())
+        return positions;
+    for (size_t pos = find(text, 0); pos < text.size(); pos = find(text, pos + pattern.size()))
+        positions.push_back(pos);
+    return positions;
+}
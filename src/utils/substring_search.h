@@ -0,0 +1,46 @@
+#ifndef SUBSTRING_SEARCH_H
+#define SUBSTRING_SEARCH_H
+
+#include <array>
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "byte_scanner.h"
+
+/*
+Finds the occurrences of one pattern, set up once per pattern. Short
+patterns are found with ByteScanner::find_substring (first and last byte
+filtered with SIMD), whose verification is bounded by the pattern length.
+Long ones with the Two-Way algorithm, linear in the text whatever the
+pattern, plus a last byte shift table that skips most of the text.
+*/
+class SubstringSearcher {
+    private:
+        // From this length on the SIMD filter's verification could get
+        // quadratic, Two-Way is used instead.
+        static constexpr size_t min_two_way_size = 32;
+
+        std::string pattern;
+        ByteScanner byte_scanner;
+        // Two-Way only.
+        size_t critical_pos; // the pattern is split into [0, critical_pos) and [critical_pos, size)
+        size_t period;
+        bool periodic; // the left part repeats in the right one, matches may overlap by the period
+        std::array<size_t, 256> shifts; // by the text byte under the pattern's last byte
+
+        void factorize();
+
+        size_t find_two_way(std::string_view text, size_t pos) const;
+    public:
+        SubstringSearcher(std::string_view pattern, ByteScanner byte_scanner = ByteScanner());
+
+        // Position of the first occurrence at or after pos (text.size() if none,
+        // or if the pattern is empty).
+        size_t find(std::string_view text, size_t pos) const;
+
+        // Positions of the non-overlapping occurrences, from left to right.
+        std::vector<size_t> find_all(std::string_view text) const;
+};
+
+#endif // SUBSTRING_SEARCH_H
@@ -3,11 +3,17 @@
 #include <utility>
 #include <memory>
 #include <fstream>
+#include <sstream>
+#include <functional>
 
 #include "../external/catch2/catch_amalgamated.hpp"
 #include "../external/nlohmann/json.hpp"
 #include "../src/core/lexer/lexer.h"
+#include "../src/core/lexer/streaming_lexer.h"
 #include "../src/core/interpreter/interpreter.h"
+#include "../src/core/name_analyzer/name_analyzer.h"
+#include "../src/core/name_analyzer/type_checker.h"
+#include "../src/utils/substring_search.h"
 
 using json = nlohmann::json;
 
@@ -26,15 +32,48 @@ std::vector<std::vector<std::string>> read_all_test_data(std::string test_group_
     return tests;
 }
 
-std::string run_lexer(const std::string& input) {
-    Lexer lexer = Lexer();
+std::string run_lexer(const std::string& input, SimdLevel simd_level = ByteScanner::best_supported_level()) {
+    Lexer lexer = Lexer(simd_level);
     std::string output;
-    for (auto &token : lexer.run(input)) {
-        output += (token->to_string() + " ");
+    TokenStream tokens = lexer.run(input);
+    for (auto &token : tokens) {
+        output += (tokens.to_string(token) + " ");
     }
     return output;
 }
 
+std::string run_streaming_lexer(const std::string& input, size_t chunk_size) {
+    std::istringstream input_stream(input);
+    StreamingLexer lexer(input_stream, chunk_size);
+    std::string output;
+    Token token;
+    while (lexer.next(token)) {
+        output += (lexer.to_string(token) + " ");
+    }
+    return output;
+}
+
+// The tree with positions, or the position of the syntax error.
+std::string dump_parse(const std::string& input, bool two_phase) {
+    std::function<std::string(Expr*)> dump = [&](Expr* expr) {
+        std::shared_ptr<ToStringVisitor> visitor = std::make_shared<ToStringVisitor>();
+        std::string output = visitor->get_to_string(expr, visitor) + "@" + std::to_string(expr->get_position()) + "[";
+        for (auto &child : expr->get_children()) {
+            output += dump(child) + " ";
+        }
+        return output + "]";
+    };
+    TokenStream tokens = Lexer().run(input);
+    Parser parser;
+    AstArena arena;
+    try {
+        return dump(two_phase ? parser.parse_two_phase(tokens, arena) : parser.parse(tokens, arena));
+    }
+    catch (const ProgramError& error) {
+        return "error@" + std::to_string(error.get_position());
+    }
+}
+
 std::string run_interpreter(const std::string& input) {
     return Interpreter().interpret(input);
 }
@@ -46,9 +85,318 @@ TEST_CASE("Lexer test on all test cases", "[lexer]") {
     }
 }
 
+TEST_CASE("Lexer output does not depend on the SIMD level", "[lexer]") {
+    std::vector<std::vector<std::string>> tests = read_all_test_data("lexer");
+    std::string long_literal = "(puts \"" + std::string(100, 'x') + "\")" + std::string(70, ' ') + "\n\t(puts \"\")";
+    tests.push_back({long_literal, run_lexer(long_literal, SimdLevel::scalar)});
+    for (auto &test : tests) {
+        for (SimdLevel level : {SimdLevel::scalar, SimdLevel::sse2, SimdLevel::avx2}) {
+            REQUIRE(run_lexer(test[0], level) == test[1]);
+        }
+    }
+}
+
+TEST_CASE("Streaming lexer matches the lexer for any chunk size", "[lexer]") {
+    std::vector<std::vector<std::string>> tests = read_all_test_data("lexer");
+    for (auto &test : tests) {
+        for (size_t chunk_size : {1, 2, 3, 7, 64}) {
+            REQUIRE(run_streaming_lexer(test[0], chunk_size) == test[1]);
+        }
+    }
+
+    // Tokens far larger than a chunk are rescanned in linear time, the window doubles.
+    std::string literal(1 << 22, 'a');
+    for (std::string program : {"(puts \"" + literal + "\")", "(set " + literal + " 1)"})
+        REQUIRE(run_streaming_lexer(program, 16) == run_lexer(program));
+}
+
+TEST_CASE("Parallel lexer matches the serial lexer", "[lexer]") {
+    std::vector<std::vector<std::string>> tests = read_all_test_data("lexer");
+    std::string program;
+    for (auto &test : tests) {
+        program += test[0] + "\n";
+    }
+    tests.push_back({program, run_lexer(program)});
+    Lexer lexer;
+    for (auto &test : tests) {
+        for (size_t thread_count : {1, 3, 8}) {
+            TokenStream tokens = lexer.run_parallel(test[0], thread_count, 1);
+            std::string output;
+            for (auto &token : tokens) {
+                output += (tokens.to_string(token) + " ");
+            }
+            REQUIRE(output == test[1]);
+        }
+    }
+    REQUIRE_THROWS(lexer.run_parallel("(puts \"a\") (puts \"b) (puts \"c\")", 4, 1));
+}
+
+TEST_CASE("Lexer decodes 64-bit numeric literals and rejects overflowing ones", "[lexer]") {
+    REQUIRE(run_lexer("9223372036854775807 -9223372036854775808") ==
+            "IntLitToken(9223372036854775807) SpaceToken() IntLitToken(-9223372036854775808) EOFToken() ");
+    REQUIRE(run_lexer("3000000000 2.5") == "IntLitToken(3000000000) SpaceToken() FloatLitToken(2.500000) EOFToken() ");
+    Lexer lexer;
+    REQUIRE_THROWS(lexer.run("(add 9223372036854775808 1)"));
+    // runtime ints are 32-bit, the literal is rejected once it becomes an AST node
+    for (Evaluator evaluator : {Evaluator::tree_walker, Evaluator::flat_ast, Evaluator::stack_vm, Evaluator::register_vm}) {
+        REQUIRE(Interpreter(evaluator).interpret("(puts \"a\")\n(puts (str 3000000000))") == "ERROR at line 2\n");
+        REQUIRE(Interpreter(evaluator).interpret("(puts (str -2147483648))") == "-2147483648\n");
+    }
+}
+
+TEST_CASE("Recursive descent parser matches the two-phase parser", "[parser]") {
+    std::vector<std::vector<std::string>> tests = read_all_test_data("lexer");
+    for (std::string program : {"(add 1 2", "(add 1 2))", "()", "(1 2)", "(add)", "(add 1 2) )", "add", "(puts (puts", "(add 1 (sub 2 3))"}) {
+        tests.push_back({program, ""});
+    }
+    for (auto &test : tests) {
+        REQUIRE(dump_parse(test[0], false) == dump_parse(test[0], true));
+    }
+}
+
 TEST_CASE("Interpreter test on all test cases", "[interpreter]") {
     std::vector<std::vector<std::string>> tests = read_all_test_data("interpreter");
     for (auto &test : tests) {
         REQUIRE(run_interpreter(test[0]) == test[1]);
     }
-}
\ No newline at end of file
+}
+
+TEST_CASE("Flat AST evaluator matches the tree walker", "[interpreter]") {
+    std::vector<std::vector<std::string>> tests = read_all_test_data("interpreter");
+    tests.push_back({"(set x 1)\n(puts y)", ""});
+    tests.push_back({"(puts \"a\")\n(set 1 2)", ""});
+    for (auto &test : tests) {
+        REQUIRE(Interpreter(Evaluator::flat_ast).interpret(test[0]) == run_interpreter(test[0]));
+    }
+}
+
+TEST_CASE("Stack VM matches the tree walker", "[interpreter]") {
+    std::vector<std::vector<std::string>> tests = read_all_test_data("interpreter");
+    tests.push_back({"(set x 1)\n(puts y)", ""});
+    tests.push_back({"(puts \"a\")\n(set 1 2)", ""});
+    tests.push_back({"(set x (add 1 2))\n(puts (str (set y x)))\n(puts (str y))", ""});
+    for (auto &test : tests) {
+        REQUIRE(Interpreter(Evaluator::stack_vm).interpret(test[0]) == run_interpreter(test[0]));
+    }
+}
+
+TEST_CASE("Register VM matches the tree walker", "[interpreter]") {
+    std::vector<std::vector<std::string>> tests = read_all_test_data("interpreter");
+    tests.push_back({"(set x 1)\n(puts y)", ""});
+    tests.push_back({"(puts \"a\")\n(set 1 2)", ""});
+    tests.push_back({"(set x (add 1 2))\n(puts (str (set y x)))\n(puts (str y))", ""});
+    tests.push_back({"(set x 1)\n(puts (str (add x (set x 5) x)))", ""});
+    tests.push_back({"(puts (str (add 1 y\n(divide 1 0))))", ""});
+    tests.push_back({"(puts (str (add (divide 1 0)\ny)))", ""});
+    for (auto &test : tests) {
+        REQUIRE(Interpreter(Evaluator::register_vm).interpret(test[0]) == run_interpreter(test[0]));
+    }
+}
+
+TEST_CASE("Streamed interpreter matches the interpreter on well-formed programs", "[interpreter]") {
+    std::vector<std::vector<std::string>> tests = read_all_test_data("interpreter");
+    for (auto &test : tests) {
+        std::istringstream input(test[0]);
+        std::ostringstream output;
+        Interpreter().interpret_stream(input, output, 5);
+        REQUIRE(output.str() == test[1]);
+    }
+
+    // Expressions before a syntax error already ran, interpret rejects the whole program.
+    for (std::string program : {"(puts \"a\")\n(add 1 2", "(puts \"a\")\n(puts \"b"}) {
+        std::istringstream input(program);
+        std::ostringstream output;
+        Interpreter().interpret_stream(input, output, 5);
+        REQUIRE(output.str() == "a\nERROR at line 2\n");
+        REQUIRE(Interpreter().interpret(program) == "ERROR at line 2\n");
+    }
+}
+
+TEST_CASE("Errors are reported with the line they were raised at", "[interpreter]") {
+    REQUIRE(run_interpreter("(puts \"a\")\n(divide 1 0)") == "a\nERROR at line 2\n");
+    REQUIRE(run_interpreter("(puts \"a\")\n\n(puts\n  (concat \"x\" 5))") == "a\nERROR at line 4\n");
+    REQUIRE(run_interpreter("(set x 1)\n(puts y)") == "ERROR at line 2\n");
+    REQUIRE(run_interpreter("(puts \"a\")\n(puts \"b") == "ERROR at line 2\n");
+    REQUIRE(run_interpreter("(puts \"a\")\n(add 1 2") == "ERROR at line 2\n");
+    REQUIRE(run_interpreter("(substring \"abc\" 1 4)") == "ERROR at line 1\n");
+
+    // large enough to be lexed in parallel, the first error is still the one reported
+    std::string large_program;
+    for (int line = 0; line < 40000; line++)
+        large_program += "(concat \"" + std::string(100, 'x') + "\" \"y\")\n";
+    REQUIRE(run_interpreter(large_program + "(puts \"a\")\n(puts \"b") == "ERROR at line 40002\n");
+    REQUIRE(run_interpreter(large_program + "(puts \"a\")") == "a\n");
+
+    std::istringstream input("(puts \"a\")\n\n(puts \"b\") (puts\n(divide 1 0))\n(puts \"c\")");
+    std::ostringstream output;
+    Interpreter().interpret_stream(input, output, 4);
+    REQUIRE(output.str() == "a\nb\nERROR at line 4\n");
+
+    // a stray ')' is reported at once, not after reading to the unterminated string
+    std::istringstream stray_input("(puts \"a\")\n(puts \"b\"))\n(puts \"c\")\n(puts \"d");
+    std::ostringstream stray_output;
+    Interpreter().interpret_stream(stray_input, stray_output, 4);
+    REQUIRE(stray_output.str() == "a\nERROR at line 2\n");
+}
+
+
+TEST_CASE("Substrings share the bytes of their string", "[interpreter]") {
+    std::string text = "The quick brown fox jumps over the lazy dog";
+    SharedString original(text);
+    SharedString slice = original.substring(4, 30);
+    SharedString nested = slice.substring(6, 20);
+    REQUIRE(slice.view() == text.substr(4, 30));
+    REQUIRE(nested.view() == text.substr(10, 20));
+    REQUIRE(nested.view().data() == original.view().data() + 10);
+    original = SharedString(); // the slices keep the bytes alive
+    REQUIRE(nested.view() == text.substr(10, 20));
+    REQUIRE(nested.substring(0, 3).view() == "bro");
+
+    std::string long_word(100, 'a');
+    REQUIRE(run_interpreter("(set s \"" + long_word + "\")\n(puts (substring (substring s 10 90) 5 7))") == "aa\n");
+}
+
+TEST_CASE("Concatenated ropes read as the concatenated bytes", "[interpreter]") {
+    SharedString appended, prepended;
+    std::string expected_appended, expected_prepended;
+    for (int i = 0; i < 2000; i++) {
+        std::string piece = "piece " + std::to_string(i) + ";";
+        appended = SharedString::concat(appended, SharedString(piece));
+        prepended = SharedString::concat(SharedString(piece), prepended);
+        expected_appended += piece;
+        expected_prepended = piece + expected_prepended;
+        if (i % 500 == 0) // viewing flattens, later pieces are added to a flat string
+            REQUIRE(appended.view() == expected_appended);
+    }
+    REQUIRE(appended.view() == expected_appended);
+    REQUIRE(prepended.substring(100, 5000).view() == expected_prepended.substr(100, 5000));
+    SharedString both = SharedString::concat(prepended, appended);
+    REQUIRE(both.view() == expected_prepended + expected_appended);
+
+    // A variable is set once, each concat result gets a new one: parta, partb, ..., partba, ...
+    auto name = [](int i) {
+        std::string digits;
+        for (; i > 0 || digits.empty(); i /= 26)
+            digits.insert(digits.begin(), char('a' + i % 26));
+        return "part" + digits;
+    };
+    std::string program = "(set " + name(0) + " \"start\")";
+    std::string expected = "start";
+    for (int i = 0; i < 300; i++) {
+        program += "\n(set " + name(i + 1) + " (concat " + name(i) + " \"" + std::string(i % 7 + 1, 'a' + i % 26) + "\"))";
+        expected += std::string(i % 7 + 1, 'a' + i % 26);
+    }
+    REQUIRE(run_interpreter(program + "\n(puts " + name(300) + ")") == expected + "\n");
+}
+
+TEST_CASE("Substring search finds what std::string::find finds", "[interpreter]") {
+    std::string mixed, periodic;
+    for (int i = 0; i < 3000; i++) { // few distinct bytes, so that partial matches are frequent
+        mixed += char('a' + (i * 7 + i / 13) % 3);
+        periodic += i % 50 == 49 ? 'b' : 'a';
+    }
+    std::vector<std::pair<std::string, std::string>> cases; // text, pattern
+    for (size_t length : {1, 2, 3, 5, 16, 17, 31, 32, 33, 40, 70})
+        for (size_t start : {0, 101, 2000, 3000 - 70})
+            cases.push_back({mixed, mixed.substr(start, length)});
+    for (std::string pattern : {std::string(40, 'a'), std::string(20, 'a') + "b" + std::string(19, 'a'),
+                                std::string(49, 'a') + "b" + std::string(10, 'a'), std::string(60, 'a') + "b"})
+        cases.push_back({periodic, pattern});
+    for (auto& [text, pattern] : cases) {
+        for (SimdLevel level : {SimdLevel::scalar, SimdLevel::sse2, SimdLevel::avx2}) {
+            SubstringSearcher searcher(pattern, ByteScanner(level));
+            for (size_t pos = 0; pos < text.size(); pos += 37) {
+                size_t expected = text.find(pattern, pos);
+                REQUIRE(searcher.find(text, pos) == (expected == std::string::npos ? text.size() : expected));
+            }
+        }
+    }
+    REQUIRE(run_interpreter("(puts (replace \"abcabcab\" \"abc\" \"X\"))") == "XXab\n");
+    REQUIRE(run_interpreter("(puts (replace \"aaaa\" \"aa\" \"a\"))") == "aa\n");
+    REQUIRE(run_interpreter("(puts (replace \"abc\" \"\" \"X\"))") == "abc\n");
+}
+
+TEST_CASE("Case conversion maps ASCII letters only, at every SIMD level", "[interpreter]") {
+    std::string text;
+    for (int i = 0; i < 3 * 256 + 45; i++) // every byte value, and a tail shorter than a vector
+        text += char(i);
+    std::string lower = text, upper = text;
+    for (char& c : lower)
+        if (c >= 'A' && c <= 'Z')
+            c += 'a' - 'A';
+    for (char& c : upper)
+        if (c >= 'a' && c <= 'z')
+            c -= 'a' - 'A';
+    for (SimdLevel level : {SimdLevel::scalar, SimdLevel::sse2, SimdLevel::avx2}) {
+        for (size_t size : {0, 1, 15, 16, 17, 31, 33, 100, 813}) {
+            std::string result(size, '\0');
+            ByteScanner(level).to_lowercase(std::string_view(text).substr(0, size), result.data());
+            REQUIRE(result == lower.substr(0, size));
+            ByteScanner(level).to_uppercase(std::string_view(text).substr(0, size), result.data());
+            REQUIRE(result == upper.substr(0, size));
+        }
+    }
+    REQUIRE(run_interpreter("(puts (uppercase \"Hello, World! \xc3\xa9\"))") == "HELLO, WORLD! \xc3\xa9\n");
+    REQUIRE(run_interpreter("(puts (lowercase \"Hello, World! \xc3\x89\"))") == "hello, world! \xc3\x89\n");
+}
+
+TEST_CASE("Names are resolved before the program runs", "[interpreter]") {
+    std::vector<std::pair<std::string, std::string>> tests = {
+        {"(set x \"a\")\n(set y (concat x \"b\"))\n(puts y)", "ab\n"},
+        {"(set y (set x 1))\n(puts (str x))\n(puts (str (equal y null)))", "1\ntrue\n"},
+        {"(puts \"a\")\n(puts x)\n(set x \"b\")", "a\nERROR at line 2\n"},
+        {"(set x x)", "ERROR at line 1\n"},
+        // a second set raises once its value is evaluated
+        {"(set x \"a\")\n(puts x)\n(set x (puts \"b\"))\n(puts \"c\")", "a\nb\nERROR at line 3\n"},
+        {"(set x \"a\")\n(set\nx (substring x 0 5))", "ERROR at line 3\n"},
+        {"(puts \"a\")\n(set 1 2)", "a\nERROR at line 2\n"},
+    };
+    for (Evaluator evaluator : {Evaluator::tree_walker, Evaluator::flat_ast, Evaluator::stack_vm, Evaluator::register_vm}) {
+        for (auto& [program, expected] : tests)
+            REQUIRE(Interpreter(evaluator).interpret(program) == expected);
+    }
+
+    std::string program = "(set x 1) (puts y) (set x 2) (set z (add x w))";
+    TokenStream tokens = Lexer().run(program);
+    AstArena arena;
+    Expr* root = Parser().parse(tokens, arena);
+    SymbolTable symbol_table;
+    NameAnalyzer analyzer(arena, symbol_table);
+    analyzer.analyze(root);
+    REQUIRE(analyzer.get_error_positions() == std::vector<uint64_t>{16, 20, 43}); // y, the second set, w
+    REQUIRE(symbol_table.size() == 2);
+    REQUIRE(symbol_table.find("z") == 1);
+}
+
+TEST_CASE("Types are checked before the program runs", "[interpreter]") {
+    std::vector<std::pair<std::string, std::string>> tests = {
+        {"(puts \"a\")\n(puts (add 1 \"b\"))", "a\nERROR at line 2\n"},
+        // the operands of a call that can't be typed still run
+        {"(puts \"a\")\n(set x (concat (puts \"b\") \"c\"))", "a\nb\nERROR at line 2\n"},
+        {"(set x 1.5)\n(puts (str (add x 2)))\n(puts (str (lt x 2)))", "3.5000\ntrue\n"},
+        {"(set x 7)\n(puts (str (divide x 2)))\n(puts (str (divide x 0)))", "3\nERROR at line 3\n"},
+        {"(puts (concat \"a\" (str (abs -2))))\n(puts (substring \"a\" 0 1.0))", "a2\nERROR at line 2\n"},
+    };
+    for (Evaluator evaluator : {Evaluator::tree_walker, Evaluator::flat_ast, Evaluator::stack_vm, Evaluator::register_vm}) {
+        for (auto& [program, expected] : tests)
+            REQUIRE(Interpreter(evaluator).interpret(program) == expected);
+    }
+
+    std::string program = "(set x 2) (set y (add x 2.5)) (puts (str (max x 3))) (puts (abs \"a\"))";
+    TokenStream tokens = Lexer().run(program);
+    AstArena arena;
+    Expr* root = Parser().parse(tokens, arena);
+    Context context;
+    NameAnalyzer(arena, context.get_symbol_table()).analyze(root);
+    context.allocate_slots();
+    TypeChecker checker(arena, context);
+    checker.check(root);
+    REQUIRE(checker.get_error_positions() == std::vector<uint64_t>{60});
+    Expr* sum = root->get_children()[1]->get_children()[1];
+    REQUIRE(sum->get_kind() == ExprKind::add_float);
+    REQUIRE(sum->get_static_type() == Type::float_type);
+    Expr* maximum = root->get_children()[2]->get_children()[0]->get_children()[0];
+    REQUIRE(maximum->get_kind() == ExprKind::max_int);
+    REQUIRE(maximum->get_static_type() == Type::int_type);
+    REQUIRE(root->get_children()[3]->get_children()[0]->get_kind() == ExprKind::error);
+}